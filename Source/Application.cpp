@@ -1,104 +1,573 @@
 #include "Application.h"
 
 #include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <cmath>
+#include <chrono>
+#include <thread>
 #include <glm/glm.hpp>
 #include <imgui.h>
 #include <imgui_impl_glfw.h>
 #include <imgui_impl_opengl3.h>
 
+#ifdef _WIN32
+#include <timeapi.h>
+#endif
+
 namespace Ogle
 {
-    void WINAPI GLDebugOutput(GLenum source, GLenum type, unsigned int id, GLenum severity, GLsizei length,
-        const char* message, const void* user_param)
+int Application::Run()
+{
+    InitializeBase();
+
+    Initialize();
+
+    if (!settings.capture_path_pattern.empty())
+        frame_capture = new FrameCapture(jobs, settings.capture_path_pattern);
+
+    if (!settings.replay_path.empty())
+        replaying = input_replayer.Open(settings.replay_path.c_str());
+    else if (!settings.record_path.empty())
+        input_recorder.Open(settings.record_path.c_str());
+
+    std::ofstream timing_csv;
+    if (!settings.timing_csv_path.empty())
     {
-        std::cout << "-----------------------" << std::endl;
-        std::cout << "Debug Message (" << id << "): " << message << std::endl;
+        timing_csv.open(settings.timing_csv_path);
+        timing_csv << "frame,elapsed_time_s,frame_interval_ms,cpu_frame_ms,update_ms\n";
+    }
 
-        switch (source)
+    if (settings.threaded_rendering)
+        StartRenderThread();
+
+    double last_frame_start_time = glfwGetTime();
+    next_frame_deadline = last_frame_start_time;
+
+    while (!glfwWindowShouldClose(window))
+    {
+        if (settings.headless && frame_times.size() == settings.headless_frame_count)
+            break;
+
+        // Wait before polling events rather than after swapping, so input isn't delayed by the limiter
+        if (settings.target_fps > 0.f)
+            WaitForNextFrame();
+
+        // Blocks until something needs a redraw. Before the frame starts, so neither its CPU time nor the profiler
+        // zones include the idle wait.
+        const bool wait_for_redraw = settings.on_demand_rendering && !settings.headless && !replaying;
+        input.BeginFrame();
+        if (wait_for_redraw)
         {
-            case GL_DEBUG_SOURCE_API: std::cout << "Source: API"; break;
-            case GL_DEBUG_SOURCE_WINDOW_SYSTEM: std::cout << "Source: Window System"; break;
-            case GL_DEBUG_SOURCE_SHADER_COMPILER: std::cout << "Source: Shader Compiler"; break;
-            case GL_DEBUG_SOURCE_THIRD_PARTY: std::cout << "Source: Third Party"; break;
-            case GL_DEBUG_SOURCE_APPLICATION: std::cout << "Source: Application"; break;
-            case GL_DEBUG_SOURCE_OTHER: std::cout << "Source: Other"; break;
+            // The idle time belongs to no frame, counting it in the frame time would make the camera jump and skew
+            // the frame time stats after every wake-up
+            last_frame_start_time += WaitForRedraw();
         }
-        std::cout << std::endl;
 
-        switch (type)
+        double frame_start_time = glfwGetTime();
+        double measured_frame_time = frame_start_time - last_frame_start_time;
+        last_frame_start_time = frame_start_time;
+
+        frame_time_stats.Add(float(measured_frame_time));
+
+        // Replaced by the recorded one while replaying
+        double frame_time = measured_frame_time;
+        double update_duration = 0.0;
+
+        profiler.BeginFrame();
         {
-            case GL_DEBUG_TYPE_ERROR:               std::cout << "Type: Error"; break;
-            case GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR: std::cout << "Type: Deprecated Behaviour"; break;
-            case GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR:  std::cout << "Type: Undefined Behaviour"; break;
-            case GL_DEBUG_TYPE_PORTABILITY:         std::cout << "Type: Portability"; break;
-            case GL_DEBUG_TYPE_PERFORMANCE:         std::cout << "Type: Performance"; break;
-            case GL_DEBUG_TYPE_MARKER:              std::cout << "Type: Marker"; break;
-            case GL_DEBUG_TYPE_PUSH_GROUP:          std::cout << "Type: Push Group"; break;
-            case GL_DEBUG_TYPE_POP_GROUP:           std::cout << "Type: Pop Group"; break;
-            case GL_DEBUG_TYPE_OTHER:               std::cout << "Type: Other"; break;
+            OGLE_PROFILE_SCOPE(profiler, "Frame");
+
+            {
+                OGLE_PROFILE_CPU_SCOPE(profiler, "Poll Events");
+                if (!wait_for_redraw)
+                    glfwPollEvents();
+
+                if (replaying)
+                {
+                    float recorded_frame_time;
+                    if (input_replayer.NextFrame(recorded_frame_time, delta_time, input))
+                        frame_time = recorded_frame_time;
+                    else
+                        glfwSetWindowShouldClose(window, GLFW_TRUE);
+                }
+                else if (input_recorder.IsOpen())
+                {
+                    input_recorder.RecordFrame(float(frame_time), delta_time, input);
+                }
+
+                this->frame_time = float(frame_time);
+                elapsed_time += frame_time;
+
+                DispatchInputEvents();
+            }
+
+            ImGui_ImplOpenGL3_NewFrame();
+            ImGui_ImplGlfw_NewFrame();
+            ImGui::NewFrame();
+
+            double update_start_time = glfwGetTime();
+            if (settings.fixed_timestep)
+            {
+                StepFixedTimestep(frame_time);
+            }
+            else
+            {
+                OGLE_PROFILE_SCOPE(profiler, "Update");
+
+                float start_time = (float)glfwGetTime();
+
+                Update();
+
+                if (!replaying)
+                    delta_time = (float)glfwGetTime() - start_time;
+            }
+            update_duration = glfwGetTime() - update_start_time;
+
+            {
+                OGLE_PROFILE_SCOPE(profiler, "ImGui");
+
+                if (settings.show_profiler_overlay)
+                {
+                    profiler.DrawOverlay(&settings.show_profiler_overlay);
+                    DrawFramePacingOverlay();
+                }
+
+                ImGui::Render();
+                if (settings.threaded_rendering)
+                    CopyImGuiDrawData(render_frames[recording_render_frame]);
+                else
+                    ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+            }
+
+            bool capture = frame_capture && settings.capture_interval > 0 &&
+                frame_index % settings.capture_interval == 0;
+            if (settings.threaded_rendering)
+            {
+                RenderFrame& frame = render_frames[recording_render_frame];
+                frame.capture = capture;
+                frame.capture_width = framebuffer_width;
+                frame.capture_height = framebuffer_height;
+            }
+            else if (capture)
+            {
+                OGLE_PROFILE_CPU_SCOPE(profiler, "Capture");
+                CaptureFrame(framebuffer_width, framebuffer_height);
+            }
+
+            if (settings.threaded_rendering)
+            {
+                OGLE_PROFILE_CPU_SCOPE(profiler, "Submit Frame");
+                SubmitRenderFrame();
+            }
+            else
+            {
+                OGLE_PROFILE_CPU_SCOPE(profiler, "Swap Buffers");
+                if (settings.headless)
+                {
+                    // Nothing gets presented, so wait for the GPU instead to make the frame times meaningful
+                    glFinish();
+                }
+                else
+                {
+                    glfwSwapBuffers(window);
+                }
+            }
+
+            if (settings.headless)
+                frame_times.push_back(float(glfwGetTime() - frame_start_time));
+
+            if (timing_csv.is_open())
+            {
+                timing_csv << frame_index << "," << elapsed_time << "," << 1000.0 * measured_frame_time << ","
+                    << 1000.0 * (glfwGetTime() - frame_start_time) << "," << 1000.0 * update_duration << "\n";
+            }
         }
-        std::cout << std::endl;
+        profiler.EndFrame();
+        debug_log.EndFrame();
+        ++frame_index;
+    }
+
+    if (settings.threaded_rendering)
+        StopRenderThread();
+
+    if (frame_capture)
+    {
+        delete frame_capture;
+        frame_capture = nullptr;
+    }
+
+    input_recorder.Close();
+
+    if (settings.headless)
+        PrintFrameTimeSummary();
+
+#ifdef _WIN32
+    if (settings.target_fps > 0.f)
+        timeEndPeriod(1);
+#endif
+
+    return 0;
+}
+
+void Application::StartRenderThread()
+{
+    // Creates the ImGui device objects while the context is still current here
+    ImGui_ImplOpenGL3_NewFrame();
+
+    render_commands = &render_frames[recording_render_frame].commands;
+    stop_render_thread = false;
+
+    glfwMakeContextCurrent(nullptr);
+    render_thread = std::thread(&Application::RenderThreadMain, this);
+}
+
+void Application::StopRenderThread()
+{
+    {
+        std::unique_lock<std::mutex> lock(render_mutex);
+        render_condition.wait(lock, [this]() { return submitted_render_frame == nullptr; });
+        stop_render_thread = true;
+    }
+    render_condition.notify_all();
+
+    render_thread.join();
+
+    // Hand the context back, so GL objects can still be deleted by the application
+    glfwMakeContextCurrent(window);
+    render_commands = nullptr;
+
+    for (RenderFrame& frame : render_frames)
+    {
+        frame.commands.Clear();
+        FreeImGuiDrawData(frame);
+    }
+}
+
+void Application::RenderThreadMain()
+{
+    glfwMakeContextCurrent(window);
 
-        switch (severity)
+    while (true)
+    {
+        RenderFrame* frame = nullptr;
         {
-            case GL_DEBUG_SEVERITY_HIGH:         std::cout << "Severity: high"; break;
-            case GL_DEBUG_SEVERITY_MEDIUM:       std::cout << "Severity: medium"; break;
-            case GL_DEBUG_SEVERITY_LOW:          std::cout << "Severity: low"; break;
-            case GL_DEBUG_SEVERITY_NOTIFICATION: std::cout << "Severity: notification"; break;
+            std::unique_lock<std::mutex> lock(render_mutex);
+            render_condition.wait(lock, [this]() { return submitted_render_frame || stop_render_thread; });
+            if (!submitted_render_frame)
+                break;
+
+            frame = submitted_render_frame;
         }
-        std::cout << std::endl;
 
-        std::cout << "----------------" << std::endl;
+        frame->commands.Execute();
+
+        if (frame->imgui_draw_data.Valid)
+            ImGui_ImplOpenGL3_RenderDrawData(&frame->imgui_draw_data);
 
-        // Todo: Can you somehow get a line number from OpenGL?
-        __debugbreak();
+        if (frame->capture)
+            CaptureFrame(frame->capture_width, frame->capture_height);
+
+        if (settings.headless)
+            glFinish();
+        else
+            glfwSwapBuffers(window);
+
+        {
+            std::lock_guard<std::mutex> lock(render_mutex);
+            submitted_render_frame = nullptr;
+        }
+        render_condition.notify_all();
     }
 
-int Application::Run()
+    glfwMakeContextCurrent(nullptr);
+}
+
+void Application::SubmitRenderFrame()
 {
-    InitializeBase();
+    {
+        std::unique_lock<std::mutex> lock(render_mutex);
+        render_condition.wait(lock, [this]() { return submitted_render_frame == nullptr; });
+        submitted_render_frame = &render_frames[recording_render_frame];
+    }
+    render_condition.notify_all();
 
-    Initialize();
+    // The render thread is done with the other frame, since it finished it before picking up this one
+    recording_render_frame ^= 1;
+    RenderFrame& next_frame = render_frames[recording_render_frame];
+    FreeImGuiDrawData(next_frame);
+    render_commands = &next_frame.commands;
+}
+
+void Application::CopyImGuiDrawData(RenderFrame& frame)
+{
+    // The draw lists are owned by ImGui and get overwritten by the next frame, while the render thread still needs
+    // them
+    const ImDrawData* draw_data = ImGui::GetDrawData();
+
+    frame.imgui_draw_lists.resize(draw_data->CmdListsCount);
+    for (int i = 0; i < draw_data->CmdListsCount; ++i)
+        frame.imgui_draw_lists[i] = draw_data->CmdLists[i]->CloneOutput();
+
+    frame.imgui_draw_data = *draw_data;
+    frame.imgui_draw_data.CmdLists = frame.imgui_draw_lists.data();
+}
+
+void Application::FreeImGuiDrawData(RenderFrame& frame)
+{
+    for (ImDrawList* draw_list : frame.imgui_draw_lists)
+        IM_DELETE(draw_list);
+    frame.imgui_draw_lists.clear();
+
+    frame.imgui_draw_data.Clear();
+}
+
+void Application::CaptureFrame(unsigned int width, unsigned int height)
+{
+    if (width == 0 || height == 0)
+        return;
+
+    // The application might have left any framebuffer bound for reading
+    GLint read_framebuffer;
+    glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &read_framebuffer);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, default_framebuffer);
+
+    frame_capture->Capture(width, height);
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, read_framebuffer);
+}
+
+void Application::StepFixedTimestep(double frame_time)
+{
+    const double step = settings.fixed_delta_time;
+    delta_time = settings.fixed_delta_time;
+
+    fixed_timestep_accumulator += frame_time;
 
-    while (!glfwWindowShouldClose(window))
     {
-        glfwPollEvents();
+        OGLE_PROFILE_SCOPE(profiler, "Fixed Update");
+
+        unsigned int step_count = 0;
+        while (fixed_timestep_accumulator >= step && step_count < settings.max_fixed_steps_per_frame)
+        {
+            FixedUpdate();
+            fixed_timestep_accumulator -= step;
+            ++step_count;
+        }
+    }
+
+    // Couldn't keep up, drop the whole steps we are behind but keep the fraction so that alpha stays continuous
+    if (fixed_timestep_accumulator >= step)
+        fixed_timestep_accumulator = std::fmod(fixed_timestep_accumulator, step);
 
-        ImGui_ImplOpenGL3_NewFrame();
-        ImGui_ImplGlfw_NewFrame();
-        ImGui::NewFrame();
+    {
+        OGLE_PROFILE_SCOPE(profiler, "Render");
+        Render(float(fixed_timestep_accumulator / step));
+    }
+}
 
-        float start_time = (float)glfwGetTime();
+void Application::WaitForNextFrame()
+{
+    const double frame_period = 1.0 / settings.target_fps;
+
+    // Advance the deadline instead of measuring from now so the error doesn't accumulate, but don't try to catch
+    // up on frames which were already missed
+    double now = glfwGetTime();
+    next_frame_deadline += frame_period;
+    if (next_frame_deadline < now - frame_period)
+        next_frame_deadline = now;
+
+    // Sleep in 1 ms steps for as long as the remaining time covers the expected length of a sleep (mean plus one
+    // standard deviation of what the past sleeps actually took), then spin
+    while (true)
+    {
+        double expected_sleep = 0.001 + sleep_overshoot_mean;
+        if (sleep_sample_count > 1)
+            expected_sleep += std::sqrt(sleep_overshoot_m2 / (sleep_sample_count - 1));
 
-        Update();
+        if (next_frame_deadline - now <= expected_sleep)
+            break;
 
-        delta_time = (float)glfwGetTime() - start_time;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
 
-        ImGui::Render();
-        ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+        double after_sleep = glfwGetTime();
+        double overshoot = (after_sleep - now) - 0.001;
+        now = after_sleep;
 
-        glfwSwapBuffers(window);
+        // Welford's running mean and variance
+        ++sleep_sample_count;
+        double delta = overshoot - sleep_overshoot_mean;
+        sleep_overshoot_mean += delta / sleep_sample_count;
+        sleep_overshoot_m2 += delta * (overshoot - sleep_overshoot_mean);
     }
 
-    return 0;
+    while (glfwGetTime() < next_frame_deadline)
+        ;
+}
+
+void Application::DrawFramePacingOverlay()
+{
+    if (ImGui::Begin("Profiler", &settings.show_profiler_overlay))
+    {
+        ImGui::Separator();
+        ImGui::Text("Frame time: mean %.3f ms, std dev %.3f ms", 1000.f * frame_time_stats.mean,
+            1000.f * std::sqrt(frame_time_stats.variance));
+        ImGui::Text("Frame time: min %.3f ms, max %.3f ms", 1000.f * frame_time_stats.min,
+            1000.f * frame_time_stats.max);
+        ImGui::Text("GL performance warnings: %u", debug_log.GetFramePerformanceWarningCount());
+    }
+    ImGui::End();
+}
+
+void FrameTimeStats::Add(float frame_time)
+{
+    samples[offset] = frame_time;
+    offset = (offset + 1) % WINDOW_SIZE;
+    if (count < WINDOW_SIZE)
+        ++count;
+
+    float sum = 0.f;
+    min = samples[0];
+    max = samples[0];
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        sum += samples[i];
+        min = samples[i] < min ? samples[i] : min;
+        max = samples[i] > max ? samples[i] : max;
+    }
+    mean = sum / count;
+
+    float squared_deviation_sum = 0.f;
+    for (unsigned int i = 0; i < count; ++i)
+        squared_deviation_sum += (samples[i] - mean) * (samples[i] - mean);
+    variance = squared_deviation_sum / count;
+}
+
+void Application::RequestRedraw()
+{
+    redraw_requested.store(true);
+    glfwPostEmptyEvent();
+}
+
+double Application::WaitForRedraw()
+{
+    // ImGui needs a couple of frames after an input to settle down (hover highlights, popups opening, ...)
+    constexpr unsigned int IMGUI_SETTLE_FRAME_COUNT = 3;
+    // The text cursor of a focused ImGui input field blinks with this period
+    constexpr double IMGUI_CURSOR_BLINK_PERIOD = 0.6;
+    // Only used to re-check the window state, a redraw needs a reason
+    constexpr double MAX_WAIT_TIME = 0.5;
+
+    glfwPollEvents();
+
+    double idle_time = 0.0;
+    while (!glfwWindowShouldClose(window))
+    {
+        double now = glfwGetTime();
+        double timeout = MAX_WAIT_TIME;
+
+        if (!glfwGetWindowAttrib(window, GLFW_ICONIFIED))
+        {
+            bool has_input = input.GetEventCount() > 0 || input.IsAnyKeyOrButtonDown();
+            if (has_input)
+                settle_frames_remaining = IMGUI_SETTLE_FRAME_COUNT;
+
+            bool should_redraw = redraw_requested.load() || has_input || settle_frames_remaining > 0;
+
+            if (ImGui::GetIO().WantTextInput)
+            {
+                double next_blink_time = last_redraw_time + 0.5 * IMGUI_CURSOR_BLINK_PERIOD;
+                should_redraw = should_redraw || now >= next_blink_time;
+                timeout = std::min(timeout, next_blink_time - now);
+            }
+
+            if (should_redraw)
+            {
+                double earliest_redraw_time = last_redraw_time;
+                if (!glfwGetWindowAttrib(window, GLFW_FOCUSED) && settings.unfocused_fps > 0.f)
+                    earliest_redraw_time += 1.0 / settings.unfocused_fps;
+
+                if (now >= earliest_redraw_time)
+                    break;
+
+                timeout = std::min(timeout, earliest_redraw_time - now);
+            }
+        }
+
+        double wait_start_time = glfwGetTime();
+        glfwWaitEventsTimeout(std::max(timeout, 0.0));
+        idle_time += glfwGetTime() - wait_start_time;
+    }
+
+    redraw_requested.store(false);
+    if (settle_frames_remaining > 0)
+        --settle_frames_remaining;
+    last_redraw_time = glfwGetTime();
+    return idle_time;
+}
+
+void Application::DispatchInputEvents()
+{
+    const InputEvent* events = input.GetEvents();
+    for (unsigned int i = 0; i < input.GetEventCount(); ++i)
+    {
+        const InputEvent& event = events[i];
+        switch (event.type)
+        {
+            case InputEventType::KeyPress:
+            case InputEventType::KeyRepeat:
+                OnKeyPress(event.code);
+                break;
+            case InputEventType::KeyRelease:
+                OnKeyRelease(event.code);
+                break;
+            case InputEventType::MouseMove:
+                OnMouseMove(event.x, event.y);
+                break;
+            case InputEventType::MouseScroll:
+                OnMouseScroll(event.x);
+                break;
+            default:
+                break;
+        }
+    }
+
+    // From the input state rather than the events, which can get dropped when too many arrive in a frame
+    if (input.WasResized())
+    {
+        GLsizei width = (GLsizei)input.GetResizeWidth();
+        GLsizei height = (GLsizei)input.GetResizeHeight();
+        framebuffer_width = (unsigned int)width;
+        framebuffer_height = (unsigned int)height;
+        SubmitRenderCommand([width, height]() { glViewport(0, 0, width, height); });
+        OnWindowResize(width, height);
+    }
 }
 
 void Application::GLFWFramebufferSizeCallback(GLFWwindow* window, int width, int height)
 {
-    glViewport(0, 0, width, height);
-    OnWindowResize(width, height);
+    if (replaying)
+        return;
+
+    input.Push({ InputEventType::WindowResize, 0, (float)width, (float)height });
 }
 
 void Application::GLFWMouseCallback(GLFWwindow* window, double x, double y)
 {
-    OnMouseMove(float(x - last_x), float(last_y - y));
+    if (replaying)
+        return;
+
+    input.Push({ InputEventType::MouseMove, 0, float(x - last_x), float(last_y - y) });
     last_x = (float)x;
     last_y = (float)y;
 }
 
 void Application::GLFWScrollCallback(GLFWwindow* window, double x_offset, double y_offset)
 {
-    OnMouseScroll((float)y_offset);
+    if (replaying)
+        return;
+
+    input.Push({ InputEventType::MouseScroll, 0, (float)y_offset, 0.f });
 }
 
 void Application::GLFWKeyCallback(GLFWwindow* window, int key, int scancode, int action, int mods)
@@ -106,20 +575,64 @@ void Application::GLFWKeyCallback(GLFWwindow* window, int key, int scancode, int
     if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS)
         glfwSetWindowShouldClose(window, GLFW_TRUE);
 
-    if (action == GLFW_PRESS || action == GLFW_REPEAT)
-        OnKeyPress(key);
+    if (replaying)
+        return;
+
+    if (action == GLFW_PRESS)
+        input.Push({ InputEventType::KeyPress, key, 0.f, 0.f });
+    else if (action == GLFW_REPEAT)
+        input.Push({ InputEventType::KeyRepeat, key, 0.f, 0.f });
+    else if (action == GLFW_RELEASE)
+        input.Push({ InputEventType::KeyRelease, key, 0.f, 0.f });
+}
+
+void Application::GLFWWindowRefreshCallback(GLFWwindow* window)
+{
+    // The window contents got damaged, e.g. by another window on top of it
+    redraw_requested.store(true);
+}
+
+void Application::GLFWMouseButtonCallback(GLFWwindow* window, int button, int action, int mods)
+{
+    if (replaying)
+        return;
+
+    if (action == GLFW_PRESS)
+        input.Push({ InputEventType::MouseButtonPress, button, 0.f, 0.f });
     else if (action == GLFW_RELEASE)
-        OnKeyRelease(key);
+        input.Push({ InputEventType::MouseButtonRelease, button, 0.f, 0.f });
 }
 
 void Application::InitializeBase()
 {
+    if (settings.headless)
+    {
+#if GLFW_VERSION_MAJOR * 1000 + GLFW_VERSION_MINOR * 100 >= 3400
+        glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+#else
+        std::cout << "Headless mode requires GLFW 3.4 or newer" << std::endl;
+        exit(-1);
+#endif
+    }
+
     if (glfwInit() != GLFW_TRUE)
         exit(-1);
 
     if (settings.enable_debug_callback)
         glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GLFW_TRUE);
 
+    if (settings.headless)
+    {
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+        glfwWindowHint(GLFW_CONTEXT_CREATION_API,
+            settings.headless_context_api == HeadlessContextAPI::EGL ? GLFW_EGL_CONTEXT_API : GLFW_OSMESA_CONTEXT_API);
+
+        // Software rasterizers like llvmpipe only expose 4.5 through the core profile
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 5);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    }
+
     window = glfwCreateWindow(settings.width, settings.height, settings.window_title.c_str(), nullptr, nullptr);
     if (!window)
     {
@@ -132,6 +645,8 @@ void Application::InitializeBase()
     glfwSetKeyCallback(window, GLFWKeyCallbackHelper);
     glfwSetCursorPosCallback(window, GLFWMouseCallbackHelper);
     glfwSetScrollCallback(window, GLFWScrollCallbackHelper);
+    glfwSetMouseButtonCallback(window, GLFWMouseButtonCallbackHelper);
+    glfwSetWindowRefreshCallback(window, GLFWWindowRefreshCallbackHelper);
 
     // Input Modes
     glfwSetInputMode(window, GLFW_CURSOR, settings.enable_cursor ? GLFW_CURSOR_NORMAL : GLFW_CURSOR_DISABLED);
@@ -146,6 +661,24 @@ void Application::InitializeBase()
         exit(-1);
     }
 
+    if (!settings.headless)
+    {
+        int swap_interval = settings.swap_interval;
+        if (swap_interval < 0 && !glfwExtensionSupported("WGL_EXT_swap_control_tear") &&
+            !glfwExtensionSupported("GLX_EXT_swap_control_tear"))
+        {
+            std::cout << "Note: Adaptive vsync isn't supported, falling back to regular vsync\n" << std::endl;
+            swap_interval = 1;
+        }
+        glfwSwapInterval(swap_interval);
+    }
+
+#ifdef _WIN32
+    // The default scheduler granularity of ~15.6 ms would make the frame limiter spin most of the time
+    if (settings.target_fps > 0.f)
+        timeBeginPeriod(1);
+#endif
+
     // Initialize ImGui
     IMGUI_CHECKVERSION();
     ImGui::CreateContext();
@@ -160,11 +693,8 @@ void Application::InitializeBase()
         glGetIntegerv(GL_CONTEXT_FLAGS, &flags);
         if (flags & GL_CONTEXT_FLAG_DEBUG_BIT)
         {
-            glEnable(GL_DEBUG_OUTPUT);
-            glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
-            glDebugMessageCallback(GLDebugOutput, nullptr);
-            glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DONT_CARE, 0, nullptr, GL_TRUE);
-    
+            debug_log.Start(settings.debug_min_severity, settings.debug_break_on_error);
+
             std::cout << "Note: Debug context initialized\n" << std::endl;
         }
     }
@@ -200,11 +730,88 @@ void Application::InitializeBase()
         // std::cout << "Max Work Group Invocations: " << max_work_group_invocations << std::endl;
     }
 
+    // Timer queries would have to be issued on the render thread
+    if (settings.enable_gpu_profiler && !settings.threaded_rendering)
+        profiler.Initialize();
+
+    jobs.Start(settings.worker_thread_count);
+
+    if (settings.headless)
+    {
+        framebuffer_width = settings.width;
+        framebuffer_height = settings.height;
+    }
+    else
+    {
+        int width, height;
+        glfwGetFramebufferSize(window, &width, &height);
+        framebuffer_width = (unsigned int)width;
+        framebuffer_height = (unsigned int)height;
+    }
+
+    if (settings.headless)
+    {
+        InitializeHeadlessFramebuffer();
+        frame_times.reserve(settings.headless_frame_count);
+    }
+
     // Mouse
     last_x = settings.width / 2.f;
     last_y = settings.height / 2.f;
 }
 
+void Application::InitializeHeadlessFramebuffer()
+{
+    glGenRenderbuffers(1, &headless_color_renderbuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, headless_color_renderbuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, settings.width, settings.height);
+
+    glGenRenderbuffers(1, &headless_depth_renderbuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, headless_depth_renderbuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, settings.width, settings.height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &default_framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, default_framebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, headless_color_renderbuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, headless_depth_renderbuffer);
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    {
+        std::cout << "Failed to create the headless framebuffer" << std::endl;
+        exit(-1);
+    }
+
+    // Leave it bound, so applications which never touch framebuffers render into it as well
+    glViewport(0, 0, settings.width, settings.height);
+}
+
+void Application::PrintFrameTimeSummary() const
+{
+    if (frame_times.empty())
+        return;
+
+    std::vector<float> sorted_frame_times = frame_times;
+    std::sort(sorted_frame_times.begin(), sorted_frame_times.end());
+
+    float total = 0.f;
+    for (float frame_time : sorted_frame_times)
+        total += frame_time;
+
+    auto percentile = [&sorted_frame_times](float p)
+    {
+        size_t index = size_t(p * (sorted_frame_times.size() - 1) + 0.5f);
+        return 1000.f * sorted_frame_times[index];
+    };
+
+    float average = total / sorted_frame_times.size();
+
+    std::cout << "Frames: " << sorted_frame_times.size() << " in " << total << " s (" << 1.f / average << " FPS)\n"
+        << "Frame time (ms): min " << 1000.f * sorted_frame_times.front() << ", avg " << 1000.f * average
+        << ", p50 " << percentile(0.5f) << ", p95 " << percentile(0.95f) << ", p99 " << percentile(0.99f)
+        << ", max " << 1000.f * sorted_frame_times.back() << std::endl;
+}
+
 void Application::GLFWFramebufferSizeCallbackHelper(GLFWwindow* window, int width, int height)
 {
     Application* app = (Application*)glfwGetWindowUserPointer(window);
@@ -228,4 +835,16 @@ void Application::GLFWKeyCallbackHelper(GLFWwindow* window, int key, int scancod
     Application* app = (Application*)glfwGetWindowUserPointer(window);
     app->GLFWKeyCallback(window, key, scancode, action, mods);
 }
+
+void Application::GLFWMouseButtonCallbackHelper(GLFWwindow* window, int button, int action, int mods)
+{
+    Application* app = (Application*)glfwGetWindowUserPointer(window);
+    app->GLFWMouseButtonCallback(window, button, action, mods);
+}
+
+void Application::GLFWWindowRefreshCallbackHelper(GLFWwindow* window)
+{
+    Application* app = (Application*)glfwGetWindowUserPointer(window);
+    app->GLFWWindowRefreshCallback(window);
+}
 }   // namespace Ogle
\ No newline at end of file
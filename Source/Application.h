@@ -1,13 +1,36 @@
 #ifndef APPLICATION_H
 
+#ifdef _WIN32
 #include "Win32.h"
+#endif
+
+#include "FrameCapture.h"
+#include "GLDebugLog.h"
+#include "Input.h"
+#include "InputRecording.h"
+#include "JobSystem.h"
+#include "Profiler.h"
+#include "RenderCommandBuffer.h"
 
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
+#include <imgui.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <utility>
+#include <vector>
 
 namespace Ogle
 {
+enum class HeadlessContextAPI
+{
+    EGL,
+    OSMesa
+};
+
 struct ApplicationSettings
 {
     unsigned int width = 1280;
@@ -15,17 +38,114 @@ struct ApplicationSettings
     std::string window_title = "Ogle";
     bool enable_cursor = true;
     bool enable_debug_callback = true;
+
+    // Debug messages below this severity are disabled. Performance warnings get counted per frame regardless of
+    // their severity, as long as it isn't filtered out.
+    GLenum debug_min_severity = GL_DEBUG_SEVERITY_LOW;
+    // Makes the debug output synchronous, so that high severity errors break inside the offending GL call
+    bool debug_break_on_error = false;
+
+    // Headless mode creates a hidden window on GLFW's null platform (requires GLFW 3.4) backed by a surfaceless EGL
+    // or an OSMesa context, so it works on machines without a display or a GPU. Rendering goes into an offscreen
+    // framebuffer, Run() returns after headless_frame_count frames and prints a frame time summary.
+    bool headless = false;
+    HeadlessContextAPI headless_context_api = HeadlessContextAPI::EGL;
+    unsigned int headless_frame_count = 100;
+
+    // GPU zones need timer queries, the CPU zones work either way
+    bool enable_gpu_profiler = true;
+    bool show_profiler_overlay = false;
+
+    // With a fixed timestep Run() calls FixedUpdate() zero or more times per frame at fixed_delta_time intervals,
+    // followed by Render(alpha) where alpha is how far the current time is between the last two simulation steps,
+    // instead of calling Update(). At most max_fixed_steps_per_frame steps run per frame, the rest of the backlog
+    // gets dropped so a slow frame can't make the following ones slower.
+    bool fixed_timestep = false;
+    float fixed_delta_time = 1.f / 60.f;
+    unsigned int max_fixed_steps_per_frame = 5;
+
+    // Threads of the job system besides the main thread, 0 means one per remaining hardware thread
+    unsigned int worker_thread_count = 0;
+
+    // Passed to glfwSwapInterval: 0 disables vsync, -1 is adaptive vsync (tears instead of waiting when a frame is
+    // late) and falls back to 1 if the driver doesn't support it
+    int swap_interval = 1;
+
+    // Caps the frame rate when > 0. The limiter sleeps for as long as it safely can and spins for the rest, so the
+    // pacing stays accurate without keeping a core busy.
+    float target_fps = 0.f;
+
+    // Instead of drawing continuously, Run() blocks in glfwWaitEventsTimeout and only draws a frame when input
+    // arrives, RequestRedraw() gets called, a key or button is held or ImGui is still animating. Nothing is drawn
+    // while the window is iconified, and at most unfocused_fps frames per second while it is unfocused.
+    bool on_demand_rendering = false;
+    float unfocused_fps = 10.f;
+
+    // Moves the GL context to a dedicated render thread after Initialize(). Update(), FixedUpdate() and Render() then
+    // must not call GL directly but record it with SubmitRenderCommand(), and the render thread executes frame N
+    // while the main thread records frame N + 1. GPU profiler zones aren't available in this mode.
+    bool threaded_rendering = false;
+
+    // Writes every capture_interval-th frame to capture_path_pattern, a printf pattern taking the capture index (e.g.
+    // "Captures/frame_%05u.png"), without stalling the main thread, see FrameCapture. Empty disables capturing.
+    std::string capture_path_pattern;
+    unsigned int capture_interval = 1;
+
+    // Writes the input events, frame times and delta times of every frame to record_path. A recording given as
+    // replay_path gets played back instead of the live input (the window should keep the recorded size), with the
+    // recorded times, and closes the application once it ends. Together with a CameraPath evaluated at
+    // elapsed_time this makes runs directly comparable, timing_csv_path writes the measured per-frame timings.
+    std::string record_path;
+    std::string replay_path;
+    std::string timing_csv_path;
+};
+
+// Statistics over the last WINDOW_SIZE frame times (start of a frame to the start of the next one), in seconds
+struct FrameTimeStats
+{
+    static constexpr unsigned int WINDOW_SIZE = 120;
+
+    void Add(float frame_time);
+
+    float mean = 0.f;
+    float variance = 0.f;
+    float min = 0.f;
+    float max = 0.f;
+
+private:
+    float samples[WINDOW_SIZE] = {};
+    unsigned int count = 0;
+    unsigned int offset = 0;
 };
 
 struct Application
 {
     virtual void Initialize() = 0;
-    virtual void Update() = 0;
+    virtual void Update() {}
+
+    // Only called when ApplicationSettings::fixed_timestep is set, see there
+    virtual void FixedUpdate() {}
+    virtual void Render(float alpha) {}
 
     virtual ~Application() {}
 
     int Run();
 
+    // Makes the next frame get drawn in on-demand mode, can be called from any thread
+    void RequestRedraw();
+
+    // Runs command (anything callable without arguments making GL calls) on the thread owning the GL context: right
+    // away, or at the time the render thread gets to it with threaded rendering. Captures are copied or moved into
+    // the command buffer, so capture by value anything which might change before the frame is executed.
+    template <typename F>
+    void SubmitRenderCommand(F&& command)
+    {
+        if (render_commands)
+            render_commands->Push(std::forward<F>(command));
+        else
+            command();
+    }
+
 protected:
     virtual void OnWindowResize(int width, int height) {}
     virtual void OnKeyPress(int key_code) {}
@@ -34,25 +154,113 @@ protected:
     virtual void OnMouseScroll(float vertical_offset) {}
 
     GLFWwindow* window = nullptr;
+
+    // Time spent in the last Update(), or fixed_delta_time with a fixed timestep
     float delta_time = 0.f;
 
+    // Time between the starts of the last two frames, use this for frame rate independent motion
+    float frame_time = 0.f;
+
+    // Sum of the frame times, deterministic while replaying a recording
+    double elapsed_time = 0.0;
+
+    // Events received this frame and the current key/button state. The virtual On* callbacks get called for the
+    // events right after polling, with consecutive mouse moves already merged.
+    Input input;
+
+    // The framebuffer which ends up being presented, bind this instead of 0. It is the offscreen framebuffer in
+    // headless mode.
+    GLuint default_framebuffer = 0;
+
+    Profiler profiler;
+    FrameTimeStats frame_time_stats;
+    GLDebugLog debug_log;
+
+    // Started before Initialize(), jobs may not make GL calls
+    JobSystem jobs;
+
     ApplicationSettings settings;
 
 private:
     void InitializeBase();
+    void InitializeHeadlessFramebuffer();
+    void StepFixedTimestep(double frame_time);
+    void WaitForNextFrame();
+    void DrawFramePacingOverlay();
+    void DispatchInputEvents();
+    // Returns the seconds spent blocked waiting for events
+    double WaitForRedraw();
+
+    struct RenderFrame
+    {
+        RenderCommandBuffer commands;
+        ImDrawData imgui_draw_data;
+        std::vector<ImDrawList*> imgui_draw_lists;
+        bool capture = false;
+        unsigned int capture_width = 0;
+        unsigned int capture_height = 0;
+    };
+
+    void StartRenderThread();
+    void StopRenderThread();
+    void RenderThreadMain();
+    void SubmitRenderFrame();
+    void CopyImGuiDrawData(RenderFrame& frame);
+    void FreeImGuiDrawData(RenderFrame& frame);
+    void CaptureFrame(unsigned int width, unsigned int height);
+    void PrintFrameTimeSummary() const;
 
     void GLFWFramebufferSizeCallback(GLFWwindow* window, int width, int height);
     void GLFWMouseCallback(GLFWwindow* window, double x_pos, double y_pos);
     void GLFWScrollCallback(GLFWwindow* window, double x_offset, double y_offset);
     void GLFWKeyCallback(GLFWwindow* window, int key, int scancode, int action, int mods);
+    void GLFWMouseButtonCallback(GLFWwindow* window, int button, int action, int mods);
+    void GLFWWindowRefreshCallback(GLFWwindow* window);
 
     static void GLFWFramebufferSizeCallbackHelper(GLFWwindow* window, int width, int height);
     static void GLFWMouseCallbackHelper(GLFWwindow* window, double x_pos, double y_pos);
     static void GLFWScrollCallbackHelper(GLFWwindow* window, double x_offset, double y_offset);
     static void GLFWKeyCallbackHelper(GLFWwindow* window, int key, int scancode, int action, int mods);
+    static void GLFWMouseButtonCallbackHelper(GLFWwindow* window, int button, int action, int mods);
+    static void GLFWWindowRefreshCallbackHelper(GLFWwindow* window);
 
     float last_x = 0.f;
     float last_y = 0.f;
+
+    GLuint headless_color_renderbuffer = 0;
+    GLuint headless_depth_renderbuffer = 0;
+    std::vector<float> frame_times;
+
+    unsigned int frame_index = 0;
+    unsigned int framebuffer_width = 0;
+    unsigned int framebuffer_height = 0;
+    FrameCapture* frame_capture = nullptr;
+
+    InputRecorder input_recorder;
+    InputReplayer input_replayer;
+    bool replaying = false;
+
+    double fixed_timestep_accumulator = 0.0;
+
+    double next_frame_deadline = 0.0;
+    double sleep_overshoot_mean = 0.0;
+    double sleep_overshoot_m2 = 0.0;
+    unsigned int sleep_sample_count = 0;
+
+    std::atomic<bool> redraw_requested{ true };
+    unsigned int settle_frames_remaining = 0;
+    double last_redraw_time = 0.0;
+
+    // Threaded rendering, the main thread records into render_commands while the render thread executes
+    // submitted_render_frame
+    RenderFrame render_frames[2];
+    unsigned int recording_render_frame = 0;
+    RenderCommandBuffer* render_commands = nullptr;
+    RenderFrame* submitted_render_frame = nullptr;
+    bool stop_render_thread = false;
+    std::mutex render_mutex;
+    std::condition_variable render_condition;
+    std::thread render_thread;
 };
 }   // namespace Ogle
 
@@ -0,0 +1,131 @@
+#include "BatchRenderer.h"
+
+#include <algorithm>
+#include <iostream>
+
+namespace Ogle
+{
+static size_t GetStreamSize(unsigned int max_draws, size_t draw_data_alignment)
+{
+    // Worst case every draw is its own batch, each batch aligns its commands and data
+    const size_t command_size = sizeof(DrawElementsIndirectCommand) + alignof(DrawElementsIndirectCommand);
+    return size_t(max_draws) * (command_size + sizeof(DrawData) + draw_data_alignment);
+}
+
+static size_t GetShaderStorageAlignment()
+{
+    GLint alignment = 16;
+    glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    return (size_t)std::max(alignment, 16);
+}
+
+BatchRenderer::BatchRenderer(unsigned int max_draws_per_frame) : draw_data_alignment(GetShaderStorageAlignment()),
+    stream(GetStreamSize(max_draws_per_frame, draw_data_alignment))
+{
+    draws.reserve(max_draws_per_frame);
+    sorted_draws.reserve(max_draws_per_frame);
+}
+
+void BatchRenderer::BeginFrame()
+{
+    stream.BeginFrame();
+}
+
+void BatchRenderer::EndFrame()
+{
+    Flush();
+    stream.EndFrame();
+}
+
+void BatchRenderer::Submit(Shader* shader, const GpuHeap* heap, const GpuMesh& mesh, const glm::mat4& model,
+    uint32_t material_index, uint32_t instance_count)
+{
+    Draw draw;
+    draw.shader = shader;
+    draw.heap = heap;
+    draw.command = { mesh.index_count, instance_count, mesh.first_index, mesh.base_vertex, 0 };
+    draw.data.model = model;
+    draw.data.material_index = material_index;
+    draws.push_back(draw);
+}
+
+void BatchRenderer::Flush()
+{
+    last_draw_count = (unsigned int)draws.size();
+    last_batch_count = 0;
+    if (draws.empty())
+        return;
+
+    sorted_draws.resize(draws.size());
+    for (uint32_t i = 0; i < sorted_draws.size(); ++i)
+        sorted_draws[i] = i;
+
+    // Stable, so draws keep their submission order within a batch
+    std::stable_sort(sorted_draws.begin(), sorted_draws.end(), [this](uint32_t a, uint32_t b)
+    {
+        const Draw& draw_a = draws[a];
+        const Draw& draw_b = draws[b];
+        if (draw_a.shader->id != draw_b.shader->id)
+            return draw_a.shader->id < draw_b.shader->id;
+        return draw_a.heap->GetVertexArray() < draw_b.heap->GetVertexArray();
+    });
+
+    stream.Bind(GL_DRAW_INDIRECT_BUFFER);
+
+    const Shader* bound_shader = nullptr;
+    const GpuHeap* bound_heap = nullptr;
+    for (size_t first = 0; first < sorted_draws.size();)
+    {
+        const Draw& first_draw = draws[sorted_draws[first]];
+
+        size_t end = first + 1;
+        while (end < sorted_draws.size() && draws[sorted_draws[end]].shader == first_draw.shader &&
+            draws[sorted_draws[end]].heap == first_draw.heap)
+        {
+            ++end;
+        }
+
+        const size_t batch_size = end - first;
+        StreamAllocation commands = stream.Allocate(batch_size * sizeof(DrawElementsIndirectCommand),
+            alignof(DrawElementsIndirectCommand));
+        StreamAllocation data = stream.Allocate(batch_size * sizeof(DrawData), draw_data_alignment);
+        if (!commands.cpu_pointer || !data.cpu_pointer)
+        {
+            std::cout << "Batch renderer ran out of stream buffer space, dropped " << sorted_draws.size() - first
+                << " draws" << std::endl;
+            break;
+        }
+
+        DrawElementsIndirectCommand* command_pointer = (DrawElementsIndirectCommand*)commands.cpu_pointer;
+        DrawData* data_pointer = (DrawData*)data.cpu_pointer;
+        for (size_t i = 0; i < batch_size; ++i)
+        {
+            const Draw& draw = draws[sorted_draws[first + i]];
+            command_pointer[i] = draw.command;
+            data_pointer[i] = draw.data;
+        }
+
+        if (first_draw.shader != bound_shader)
+        {
+            first_draw.shader->Bind();
+            bound_shader = first_draw.shader;
+        }
+
+        if (first_draw.heap != bound_heap)
+        {
+            first_draw.heap->Bind();
+            bound_heap = first_draw.heap;
+        }
+
+        stream.BindRange(GL_SHADER_STORAGE_BUFFER, DRAW_DATA_BINDING, data);
+        glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (const void*)commands.gpu_offset,
+            (GLsizei)batch_size, 0);
+
+        ++last_batch_count;
+        first = end;
+    }
+
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    draws.clear();
+}
+}   // namespace Ogle
@@ -0,0 +1,79 @@
+#ifndef BATCH_RENDERER_H
+
+#include "GpuHeap.h"
+#include "Shader.h"
+#include "StreamBuffer.h"
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace Ogle
+{
+// Layout of glMultiDrawElementsIndirect's commands
+struct DrawElementsIndirectCommand
+{
+    GLuint count;
+    GLuint instance_count;
+    GLuint first_index;
+    GLint base_vertex;
+    GLuint base_instance;
+};
+
+// One per draw, std430 layout. The shader reads it as
+//     struct DrawData { mat4 model; uint material_index; };
+//     layout (std430, binding = 0) readonly buffer DrawDataBuffer { DrawData draws[]; };
+//     ... draws[gl_DrawID] ...
+// which needs #version 460 (or ARB_shader_draw_parameters).
+struct DrawData
+{
+    glm::mat4 model;
+    uint32_t material_index;
+    uint32_t padding[3];
+};
+
+// Collects the frame's draws and submits every run of draws sharing a shader and GpuHeap with a single
+// glMultiDrawElementsIndirect. The commands and the per draw data are written to a StreamBuffer, so nothing is
+// reallocated and the CPU never waits on the GPU reading the previous frames'.
+struct BatchRenderer
+{
+    static constexpr GLuint DRAW_DATA_BINDING = 0;
+
+    explicit BatchRenderer(unsigned int max_draws_per_frame);
+
+    void BeginFrame();
+    void EndFrame();
+
+    void Submit(Shader* shader, const GpuHeap* heap, const GpuMesh& mesh, const glm::mat4& model,
+        uint32_t material_index = 0, uint32_t instance_count = 1);
+
+    // Sorts the submitted draws by shader and heap and draws them, leaves the last shader and vertex array bound
+    void Flush();
+
+    // Of the last Flush()
+    inline unsigned int GetDrawCount() const { return last_draw_count; }
+    inline unsigned int GetBatchCount() const { return last_batch_count; }
+
+private:
+    struct Draw
+    {
+        Shader* shader;
+        const GpuHeap* heap;
+        DrawElementsIndirectCommand command;
+        DrawData data;
+    };
+
+    size_t draw_data_alignment;     // GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT
+    StreamBuffer stream;
+
+    std::vector<Draw> draws;
+    std::vector<uint32_t> sorted_draws;
+
+    unsigned int last_draw_count = 0;
+    unsigned int last_batch_count = 0;
+};
+}   // namespace Ogle
+
+#define BATCH_RENDERER_H
+#endif
@@ -15,29 +15,89 @@ void Camera::ProcessKeyboard(int key_code, float delta_time)
     float delta_distance = movement_speed * delta_time;
 
     if (key_code == GLFW_KEY_W)
-        position += front * delta_distance;
+        SetPosition(position + front * delta_distance);
     if (key_code == GLFW_KEY_S)
-        position -= front * delta_distance;
+        SetPosition(position - front * delta_distance);
     if (key_code == GLFW_KEY_A)
-        position -= right * delta_distance;
+        SetPosition(position - right * delta_distance);
     if (key_code == GLFW_KEY_D)
-        position += right * delta_distance;
+        SetPosition(position + right * delta_distance);
+}
+
+void Camera::ProcessKeyboard(const Input& input, float frame_time)
+{
+    glm::vec3 direction(0.f);
+
+    if (input.IsKeyDown(GLFW_KEY_W))
+        direction += front;
+    if (input.IsKeyDown(GLFW_KEY_S))
+        direction -= front;
+    if (input.IsKeyDown(GLFW_KEY_A))
+        direction -= right;
+    if (input.IsKeyDown(GLFW_KEY_D))
+        direction += right;
+
+    // Moving diagonally shouldn't be faster
+    if (glm::dot(direction, direction) > 0.f)
+        SetPosition(position + glm::normalize(direction) * (movement_speed * frame_time));
 }
 
 void Camera::ProcessMouseMove(float x_offset, float y_offset)
 {
-    yaw += mouse_sensitivity * x_offset;
-    pitch += mouse_sensitivity * y_offset;
+    SetOrientation(yaw + mouse_sensitivity * x_offset, pitch + mouse_sensitivity * y_offset);
+}
 
-    pitch = glm::clamp(pitch, -89.f, 89.f);
+void Camera::SetPosition(const glm::vec3& position_)
+{
+    if (position_ != position)
+    {
+        position = position_;
+        view_dirty = true;
+    }
+}
 
-    UpdateCameraVectors();
+void Camera::SetOrientation(float yaw_, float pitch_)
+{
+    pitch_ = glm::clamp(pitch_, -89.f, 89.f);
+    if (yaw_ != yaw || pitch_ != pitch)
+    {
+        yaw = yaw_;
+        pitch = pitch_;
+        UpdateCameraVectors();
+    }
 }
 
 void Camera::ProcessMouseScroll(float vertical_offset)
 {
-    fov_y -= vertical_offset;
-    fov_y = glm::clamp(fov_y, 1.f, 45.f);
+    SetFovY(glm::clamp(fov_y - vertical_offset, 1.f, 45.f));
+}
+
+void Camera::SetFovY(float fov_y_)
+{
+    if (fov_y_ != fov_y)
+    {
+        fov_y = fov_y_;
+        projection_dirty = true;
+    }
+}
+
+void Camera::SetClipPlanes(float near_, float far_)
+{
+    if (near_ != z_near || far_ != z_far)
+    {
+        z_near = near_;
+        z_far = far_;
+        projection_dirty = true;
+    }
+}
+
+void Camera::SetAspectRatio(float aspect_ratio_)
+{
+    if (aspect_ratio_ != aspect_ratio)
+    {
+        aspect_ratio = aspect_ratio_;
+        projection_dirty = true;
+    }
 }
 
 void Camera::UpdateCameraVectors()
@@ -49,5 +109,32 @@ void Camera::UpdateCameraVectors()
 
     right = glm::normalize(glm::cross(front, world_up));
     up = glm::normalize(glm::cross(right, front));
+
+    view_dirty = true;
+}
+
+void Camera::UpdateMatrices() const
+{
+    if (!view_dirty && !projection_dirty)
+        return;
+
+    if (view_dirty)
+    {
+        view = glm::lookAt(position, position + front, up);
+        inverse_view = glm::inverse(view);
+    }
+
+    if (projection_dirty)
+    {
+        projection = glm::perspective(glm::radians(fov_y), aspect_ratio, z_near, z_far);
+        inverse_projection = glm::inverse(projection);
+    }
+
+    proj_view = projection * view;
+    inverse_proj_view = inverse_view * inverse_projection;
+    frustum = Frustum::FromMatrix(proj_view);
+
+    view_dirty = false;
+    projection_dirty = false;
 }
 }   // namespace Ogle
\ No newline at end of file
@@ -1,5 +1,8 @@
 #ifndef CAMERA_H
 
+#include "Culling.h"
+#include "Input.h"
+
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
@@ -10,20 +13,61 @@ struct Camera
     Camera(const glm::vec3& position_, float near_ = 0.1f, float far_ = 1000.f, float movement_speed_ = 10000.f,
         float mouse_sensitivity_ = 0.1f);
 
-    inline glm::mat4 GetProjViewMatrix(float aspect_ratio) const
+    // The matrices are cached and only recomputed after the state they depend on changed. Note: Despite being
+    // const, the getters below write that cache, so only call them on the thread owning the camera. Jobs should get
+    // copies of what they need (as CullMeshlets does) instead of calling them concurrently.
+    inline const glm::mat4& GetViewMatrix() const { UpdateMatrices(); return view; }
+    inline const glm::mat4& GetProjectionMatrix() const { UpdateMatrices(); return projection; }
+    inline const glm::mat4& GetProjViewMatrix() const { UpdateMatrices(); return proj_view; }
+    inline const glm::mat4& GetInverseViewMatrix() const { UpdateMatrices(); return inverse_view; }
+    inline const glm::mat4& GetInverseProjectionMatrix() const { UpdateMatrices(); return inverse_projection; }
+    inline const glm::mat4& GetInverseProjViewMatrix() const { UpdateMatrices(); return inverse_proj_view; }
+
+    // World space planes of the view frustum, for CullSpheres/CullBoxes
+    inline const Frustum& GetFrustum() const { UpdateMatrices(); return frustum; }
+
+    inline const glm::mat4& GetProjViewMatrix(float aspect_ratio_)
     {
-        return glm::perspective(glm::radians(fov_y), aspect_ratio, z_near, z_far) * glm::lookAt(position, position + front, up);
+        SetAspectRatio(aspect_ratio_);
+        return GetProjViewMatrix();
     }
 
-    // Todo: This keyboard movement is kind of choppy fix it ffs
+    inline const glm::vec3& GetPosition() const { return position; }
+    void SetPosition(const glm::vec3& position_);
+
+    inline const glm::vec3& GetFront() const { return front; }
+    inline const glm::vec3& GetRight() const { return right; }
+    inline const glm::vec3& GetUp() const { return up; }
+    inline float GetYaw() const { return yaw; }
+    inline float GetPitch() const { return pitch; }
+
+    // In degrees
+    inline float GetFovY() const { return fov_y; }
+    void SetFovY(float fov_y_);
+
+    inline float GetNear() const { return z_near; }
+    inline float GetFar() const { return z_far; }
+    void SetClipPlanes(float near_, float far_);
+
+    inline float GetAspectRatio() const { return aspect_ratio; }
+    void SetAspectRatio(float aspect_ratio_);
+
+    // Moves one step per key event, which makes the movement depend on the key repeat rate
     void ProcessKeyboard(int key_code, float delta_time);
+
+    // Moves continuously while WASD is held, pass the frame time for frame rate independent movement
+    void ProcessKeyboard(const Input& input, float frame_time);
     void ProcessMouseMove(float x_offset, float y_offset);
     void ProcessMouseScroll(float vertical_offset);
 
-    glm::vec3 position;
+    // In degrees, pitch gets clamped like with mouse movement
+    void SetOrientation(float yaw_, float pitch_);
 
 private:
     void UpdateCameraVectors();
+    void UpdateMatrices() const;
+
+    glm::vec3 position;
 
     glm::vec3 front;        // Z
     glm::vec3 right;        // X
@@ -39,6 +83,19 @@ private:
 
     float z_near;
     float z_far;
+    float aspect_ratio = 1.f;
+
+    // Lazily updated by the const getters, not thread safe
+    mutable bool view_dirty = true;
+    mutable bool projection_dirty = true;
+
+    mutable glm::mat4 view;
+    mutable glm::mat4 projection;
+    mutable glm::mat4 proj_view;
+    mutable glm::mat4 inverse_view;
+    mutable glm::mat4 inverse_projection;
+    mutable glm::mat4 inverse_proj_view;
+    mutable Frustum frustum;
 };
 }   // namespace Ogle
 
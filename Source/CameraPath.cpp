@@ -0,0 +1,101 @@
+#include "CameraPath.h"
+
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+namespace Ogle
+{
+static float CatmullRom(float p0, float p1, float p2, float p3, float t)
+{
+    float t2 = t * t;
+    float t3 = t2 * t;
+    return 0.5f * ((2.f * p1) + (p2 - p0) * t + (2.f * p0 - 5.f * p1 + 4.f * p2 - p3) * t2 +
+        (3.f * p1 - p0 - 3.f * p2 + p3) * t3);
+}
+
+CameraPath* CameraPath::CreateFromFile(const char* path)
+{
+    std::ifstream file(path);
+    if (!file)
+    {
+        std::cout << "Failed to open camera path: " << path << std::endl;
+        return nullptr;
+    }
+
+    CameraPath* result = new CameraPath;
+
+    std::string line;
+    while (std::getline(file, line))
+    {
+        if (line.empty() || line[0] == '#')
+            continue;
+
+        std::istringstream line_stream(line);
+        Keyframe keyframe;
+        if (line_stream >> keyframe.time >> keyframe.position.x >> keyframe.position.y >> keyframe.position.z >>
+            keyframe.yaw >> keyframe.pitch)
+        {
+            result->AddKeyframe(keyframe);
+        }
+    }
+
+    return result;
+}
+
+void CameraPath::AddKeyframe(const Keyframe& keyframe)
+{
+    keyframes.push_back(keyframe);
+
+    // Unwrap the yaw relative to the previous keyframe, so e.g. 350 to 10 degrees turns 20 degrees rather than 340
+    if (keyframes.size() > 1)
+    {
+        float previous_yaw = keyframes[keyframes.size() - 2].yaw;
+        float& yaw = keyframes.back().yaw;
+        yaw = previous_yaw + std::remainder(yaw - previous_yaw, 360.f);
+    }
+}
+
+void CameraPath::Apply(Camera& camera, float time) const
+{
+    if (keyframes.empty())
+        return;
+
+    if (time <= keyframes.front().time || keyframes.size() == 1)
+    {
+        camera.SetPosition(keyframes.front().position);
+        camera.SetOrientation(keyframes.front().yaw, keyframes.front().pitch);
+        return;
+    }
+
+    if (time >= keyframes.back().time)
+    {
+        camera.SetPosition(keyframes.back().position);
+        camera.SetOrientation(keyframes.back().yaw, keyframes.back().pitch);
+        return;
+    }
+
+    size_t segment = 0;
+    while (keyframes[segment + 1].time < time)
+        ++segment;
+
+    // The end points are duplicated for the outer segments
+    const Keyframe& k0 = keyframes[segment > 0 ? segment - 1 : 0];
+    const Keyframe& k1 = keyframes[segment];
+    const Keyframe& k2 = keyframes[segment + 1];
+    const Keyframe& k3 = keyframes[segment + 2 < keyframes.size() ? segment + 2 : segment + 1];
+
+    float segment_duration = k2.time - k1.time;
+    float t = segment_duration > 0.f ? (time - k1.time) / segment_duration : 0.f;
+
+    glm::vec3 position;
+    for (int i = 0; i < 3; ++i)
+        position[i] = CatmullRom(k0.position[i], k1.position[i], k2.position[i], k3.position[i], t);
+
+    camera.SetPosition(position);
+    camera.SetOrientation(CatmullRom(k0.yaw, k1.yaw, k2.yaw, k3.yaw, t),
+        CatmullRom(k0.pitch, k1.pitch, k2.pitch, k3.pitch, t));
+}
+}   // namespace Ogle
@@ -0,0 +1,39 @@
+#ifndef CAMERA_PATH_H
+
+#include "Camera.h"
+
+#include <glm/glm.hpp>
+#include <vector>
+
+namespace Ogle
+{
+// Scripted camera flythrough, a Catmull-Rom spline through keyframes. Evaluating it at the replayed time keeps the
+// camera path identical across runs.
+struct CameraPath
+{
+    struct Keyframe
+    {
+        float time;
+        glm::vec3 position;
+        float yaw;
+        float pitch;
+    };
+
+    // One keyframe per line: time x y z yaw pitch, lines starting with # are ignored
+    static CameraPath* CreateFromFile(const char* path);
+
+    // Keyframes must be sorted by time. The yaw (in degrees) takes the shortest way from the previous keyframe's.
+    void AddKeyframe(const Keyframe& keyframe);
+
+    // Time is clamped to the path's duration
+    void Apply(Camera& camera, float time) const;
+
+    inline float GetDuration() const { return keyframes.empty() ? 0.f : keyframes.back().time; }
+
+private:
+    std::vector<Keyframe> keyframes;
+};
+}   // namespace Ogle
+
+#define CAMERA_PATH_H
+#endif
@@ -0,0 +1,242 @@
+#include "Culling.h"
+#include "CullingSIMD.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define OGLE_CULLING_SSE
+#include <emmintrin.h>
+#endif
+
+#if defined(OGLE_CULLING_AVX) && defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace Ogle
+{
+#ifdef OGLE_CULLING_AVX
+// Needs the OS to save the YMM registers as well, not only the CPU's support
+static bool HasAVX()
+{
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 1);
+    const bool os_uses_xsave = (info[2] & (1 << 27)) != 0;
+    const bool cpu_has_avx = (info[2] & (1 << 28)) != 0;
+    return os_uses_xsave && cpu_has_avx && (_xgetbv(0) & 6) == 6;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx");
+#endif
+}
+
+static const bool HAS_AVX = HasAVX();
+#endif
+
+Frustum Frustum::FromMatrix(const glm::mat4& proj_view)
+{
+    // glm is column major, so the rows are strided
+    glm::vec4 row[4];
+    for (int i = 0; i < 4; ++i)
+        row[i] = glm::vec4(proj_view[0][i], proj_view[1][i], proj_view[2][i], proj_view[3][i]);
+
+    Frustum result;
+    result.planes[Left] = row[3] + row[0];
+    result.planes[Right] = row[3] - row[0];
+    result.planes[Bottom] = row[3] + row[1];
+    result.planes[Top] = row[3] - row[1];
+    result.planes[Near] = row[3] + row[2];
+    result.planes[Far] = row[3] - row[2];
+
+    for (glm::vec4& plane : result.planes)
+        plane /= glm::length(glm::vec3(plane));
+
+    return result;
+}
+
+void BoundingSpheres::Add(const glm::vec3& center, float radius_)
+{
+    center_x.push_back(center.x);
+    center_y.push_back(center.y);
+    center_z.push_back(center.z);
+    radius.push_back(radius_);
+}
+
+void BoundingSpheres::Clear()
+{
+    center_x.clear();
+    center_y.clear();
+    center_z.clear();
+    radius.clear();
+}
+
+void BoundingBoxes::Add(const glm::vec3& min, const glm::vec3& max)
+{
+    glm::vec3 center = 0.5f * (min + max);
+    glm::vec3 extent = 0.5f * (max - min);
+
+    center_x.push_back(center.x);
+    center_y.push_back(center.y);
+    center_z.push_back(center.z);
+    extent_x.push_back(extent.x);
+    extent_y.push_back(extent.y);
+    extent_z.push_back(extent.z);
+}
+
+void BoundingBoxes::Clear()
+{
+    center_x.clear();
+    center_y.clear();
+    center_z.clear();
+    extent_x.clear();
+    extent_y.clear();
+    extent_z.clear();
+}
+
+static inline bool IsSphereVisible(const Frustum& frustum, float x, float y, float z, float radius)
+{
+    for (const glm::vec4& plane : frustum.planes)
+    {
+        if (plane.x * x + plane.y * y + plane.z * z + plane.w < -radius)
+            return false;
+    }
+    return true;
+}
+
+static inline bool IsBoxVisible(const Frustum& frustum, float x, float y, float z, float ex, float ey, float ez)
+{
+    for (const glm::vec4& plane : frustum.planes)
+    {
+        float distance = plane.x * x + plane.y * y + plane.z * z + plane.w;
+        float projected_extent = glm::abs(plane.x) * ex + glm::abs(plane.y) * ey + glm::abs(plane.z) * ez;
+        if (distance < -projected_extent)
+            return false;
+    }
+    return true;
+}
+
+unsigned int CullSpheres(const Frustum& frustum, const BoundingSpheres& spheres, unsigned int first, unsigned int end,
+    unsigned int* visible_indices)
+{
+    const float* cx = spheres.center_x.data();
+    const float* cy = spheres.center_y.data();
+    const float* cz = spheres.center_z.data();
+    const float* r = spheres.radius.data();
+
+    unsigned int visible_count = 0;
+    unsigned int i = first;
+
+#ifdef OGLE_CULLING_AVX
+    if (HAS_AVX)
+        visible_count = CullSpheresAVX(frustum, cx, cy, cz, r, i, end, visible_indices);
+#endif
+
+#ifdef OGLE_CULLING_SSE
+    {
+        __m128 plane_x[Frustum::PLANE_COUNT], plane_y[Frustum::PLANE_COUNT], plane_z[Frustum::PLANE_COUNT],
+            plane_w[Frustum::PLANE_COUNT];
+        for (int p = 0; p < Frustum::PLANE_COUNT; ++p)
+        {
+            plane_x[p] = _mm_set1_ps(frustum.planes[p].x);
+            plane_y[p] = _mm_set1_ps(frustum.planes[p].y);
+            plane_z[p] = _mm_set1_ps(frustum.planes[p].z);
+            plane_w[p] = _mm_set1_ps(frustum.planes[p].w);
+        }
+
+        const __m128 sign_bit = _mm_set1_ps(-0.f);
+        for (; i + 4 <= end; i += 4)
+        {
+            __m128 x = _mm_loadu_ps(cx + i);
+            __m128 y = _mm_loadu_ps(cy + i);
+            __m128 z = _mm_loadu_ps(cz + i);
+            __m128 negative_radius = _mm_xor_ps(_mm_loadu_ps(r + i), sign_bit);
+
+            __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+            for (int p = 0; p < Frustum::PLANE_COUNT; ++p)
+            {
+                __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(plane_x[p], x), _mm_mul_ps(plane_y[p], y)),
+                    _mm_add_ps(_mm_mul_ps(plane_z[p], z), plane_w[p]));
+                inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negative_radius));
+            }
+
+            visible_count = Compact<4>(_mm_movemask_ps(inside), i, visible_indices, visible_count);
+        }
+    }
+#endif
+
+    for (; i < end; ++i)
+    {
+        if (IsSphereVisible(frustum, cx[i], cy[i], cz[i], r[i]))
+            visible_indices[visible_count++] = i;
+    }
+
+    return visible_count;
+}
+
+unsigned int CullBoxes(const Frustum& frustum, const BoundingBoxes& boxes, unsigned int first, unsigned int end,
+    unsigned int* visible_indices)
+{
+    const float* cx = boxes.center_x.data();
+    const float* cy = boxes.center_y.data();
+    const float* cz = boxes.center_z.data();
+    const float* ex = boxes.extent_x.data();
+    const float* ey = boxes.extent_y.data();
+    const float* ez = boxes.extent_z.data();
+
+    unsigned int visible_count = 0;
+    unsigned int i = first;
+
+    // The absolute plane normals project the extents onto the plane normal
+#ifdef OGLE_CULLING_AVX
+    if (HAS_AVX)
+        visible_count = CullBoxesAVX(frustum, cx, cy, cz, ex, ey, ez, i, end, visible_indices);
+#endif
+
+#ifdef OGLE_CULLING_SSE
+    {
+        __m128 plane_x[Frustum::PLANE_COUNT], plane_y[Frustum::PLANE_COUNT], plane_z[Frustum::PLANE_COUNT],
+            plane_w[Frustum::PLANE_COUNT], abs_x[Frustum::PLANE_COUNT], abs_y[Frustum::PLANE_COUNT],
+            abs_z[Frustum::PLANE_COUNT];
+        for (int p = 0; p < Frustum::PLANE_COUNT; ++p)
+        {
+            plane_x[p] = _mm_set1_ps(frustum.planes[p].x);
+            plane_y[p] = _mm_set1_ps(frustum.planes[p].y);
+            plane_z[p] = _mm_set1_ps(frustum.planes[p].z);
+            plane_w[p] = _mm_set1_ps(frustum.planes[p].w);
+            abs_x[p] = _mm_set1_ps(glm::abs(frustum.planes[p].x));
+            abs_y[p] = _mm_set1_ps(glm::abs(frustum.planes[p].y));
+            abs_z[p] = _mm_set1_ps(glm::abs(frustum.planes[p].z));
+        }
+
+        const __m128 sign_bit = _mm_set1_ps(-0.f);
+        for (; i + 4 <= end; i += 4)
+        {
+            __m128 x = _mm_loadu_ps(cx + i);
+            __m128 y = _mm_loadu_ps(cy + i);
+            __m128 z = _mm_loadu_ps(cz + i);
+            __m128 extent_x = _mm_loadu_ps(ex + i);
+            __m128 extent_y = _mm_loadu_ps(ey + i);
+            __m128 extent_z = _mm_loadu_ps(ez + i);
+
+            __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+            for (int p = 0; p < Frustum::PLANE_COUNT; ++p)
+            {
+                __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(plane_x[p], x), _mm_mul_ps(plane_y[p], y)),
+                    _mm_add_ps(_mm_mul_ps(plane_z[p], z), plane_w[p]));
+                __m128 projected_extent = _mm_add_ps(_mm_add_ps(_mm_mul_ps(abs_x[p], extent_x),
+                    _mm_mul_ps(abs_y[p], extent_y)), _mm_mul_ps(abs_z[p], extent_z));
+                inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, _mm_xor_ps(projected_extent, sign_bit)));
+            }
+
+            visible_count = Compact<4>(_mm_movemask_ps(inside), i, visible_indices, visible_count);
+        }
+    }
+#endif
+
+    for (; i < end; ++i)
+    {
+        if (IsBoxVisible(frustum, cx[i], cy[i], cz[i], ex[i], ey[i], ez[i]))
+            visible_indices[visible_count++] = i;
+    }
+
+    return visible_count;
+}
+}   // namespace Ogle
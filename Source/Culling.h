@@ -0,0 +1,70 @@
+#ifndef CULLING_H
+
+#include <glm/glm.hpp>
+#include <vector>
+
+namespace Ogle
+{
+// Planes as (normal, distance) with normals pointing inwards, a point p is inside a plane when dot(normal, p) + distance >= 0
+struct Frustum
+{
+    enum Plane { Left, Right, Bottom, Top, Near, Far, PLANE_COUNT };
+
+    // Extracts the normalized planes from a view-projection matrix (OpenGL clip space)
+    static Frustum FromMatrix(const glm::mat4& proj_view);
+
+    glm::vec4 planes[PLANE_COUNT];
+};
+
+// Bounding volumes in SoA layout, so the culling functions can test several objects per instruction
+struct BoundingSpheres
+{
+    void Add(const glm::vec3& center, float radius);
+    void Clear();
+
+    inline unsigned int GetCount() const { return (unsigned int)radius.size(); }
+
+    std::vector<float> center_x;
+    std::vector<float> center_y;
+    std::vector<float> center_z;
+    std::vector<float> radius;
+};
+
+// AABBs, stored as center and half extent
+struct BoundingBoxes
+{
+    void Add(const glm::vec3& min, const glm::vec3& max);
+    void Clear();
+
+    inline unsigned int GetCount() const { return (unsigned int)extent_x.size(); }
+
+    std::vector<float> center_x;
+    std::vector<float> center_y;
+    std::vector<float> center_z;
+    std::vector<float> extent_x;
+    std::vector<float> extent_y;
+    std::vector<float> extent_z;
+};
+
+// Write the indices of the volumes intersecting the frustum to visible_indices, which must have room for all of
+// them, and return how many were written. The indices stay in ascending order. Conservative: volumes near the
+// frustum's corners may be reported as visible even though they aren't. Only the volumes in [first, end) are tested,
+// e.g. to split the work into jobs.
+unsigned int CullSpheres(const Frustum& frustum, const BoundingSpheres& spheres, unsigned int first, unsigned int end,
+    unsigned int* visible_indices);
+unsigned int CullBoxes(const Frustum& frustum, const BoundingBoxes& boxes, unsigned int first, unsigned int end,
+    unsigned int* visible_indices);
+
+inline unsigned int CullSpheres(const Frustum& frustum, const BoundingSpheres& spheres, unsigned int* visible_indices)
+{
+    return CullSpheres(frustum, spheres, 0, spheres.GetCount(), visible_indices);
+}
+
+inline unsigned int CullBoxes(const Frustum& frustum, const BoundingBoxes& boxes, unsigned int* visible_indices)
+{
+    return CullBoxes(frustum, boxes, 0, boxes.GetCount(), visible_indices);
+}
+}   // namespace Ogle
+
+#define CULLING_H
+#endif
@@ -0,0 +1,91 @@
+#include "CullingSIMD.h"
+
+#include <immintrin.h>
+
+// Note: This file is compiled with AVX enabled, see CMakeLists.txt
+namespace Ogle
+{
+unsigned int CullSpheresAVX(const Frustum& frustum, const float* cx, const float* cy, const float* cz, const float* r,
+    unsigned int& i, unsigned int end, unsigned int* visible_indices)
+{
+    unsigned int visible_count = 0;
+
+    __m256 plane_x[Frustum::PLANE_COUNT], plane_y[Frustum::PLANE_COUNT], plane_z[Frustum::PLANE_COUNT],
+        plane_w[Frustum::PLANE_COUNT];
+    for (int p = 0; p < Frustum::PLANE_COUNT; ++p)
+    {
+        plane_x[p] = _mm256_set1_ps(frustum.planes[p].x);
+        plane_y[p] = _mm256_set1_ps(frustum.planes[p].y);
+        plane_z[p] = _mm256_set1_ps(frustum.planes[p].z);
+        plane_w[p] = _mm256_set1_ps(frustum.planes[p].w);
+    }
+
+    const __m256 sign_bit = _mm256_set1_ps(-0.f);
+    for (; i + 8 <= end; i += 8)
+    {
+        __m256 x = _mm256_loadu_ps(cx + i);
+        __m256 y = _mm256_loadu_ps(cy + i);
+        __m256 z = _mm256_loadu_ps(cz + i);
+        __m256 negative_radius = _mm256_xor_ps(_mm256_loadu_ps(r + i), sign_bit);
+
+        __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (int p = 0; p < Frustum::PLANE_COUNT; ++p)
+        {
+            __m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(plane_x[p], x), _mm256_mul_ps(plane_y[p], y)),
+                _mm256_add_ps(_mm256_mul_ps(plane_z[p], z), plane_w[p]));
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, negative_radius, _CMP_GE_OQ));
+        }
+
+        visible_count = Compact<8>(_mm256_movemask_ps(inside), i, visible_indices, visible_count);
+    }
+
+    return visible_count;
+}
+
+// The absolute plane normals project the extents onto the plane normal
+unsigned int CullBoxesAVX(const Frustum& frustum, const float* cx, const float* cy, const float* cz, const float* ex,
+    const float* ey, const float* ez, unsigned int& i, unsigned int end, unsigned int* visible_indices)
+{
+    unsigned int visible_count = 0;
+
+    const __m256 sign_bit = _mm256_set1_ps(-0.f);
+    __m256 plane_x[Frustum::PLANE_COUNT], plane_y[Frustum::PLANE_COUNT], plane_z[Frustum::PLANE_COUNT],
+        plane_w[Frustum::PLANE_COUNT], abs_x[Frustum::PLANE_COUNT], abs_y[Frustum::PLANE_COUNT],
+        abs_z[Frustum::PLANE_COUNT];
+    for (int p = 0; p < Frustum::PLANE_COUNT; ++p)
+    {
+        plane_x[p] = _mm256_set1_ps(frustum.planes[p].x);
+        plane_y[p] = _mm256_set1_ps(frustum.planes[p].y);
+        plane_z[p] = _mm256_set1_ps(frustum.planes[p].z);
+        plane_w[p] = _mm256_set1_ps(frustum.planes[p].w);
+        abs_x[p] = _mm256_set1_ps(glm::abs(frustum.planes[p].x));
+        abs_y[p] = _mm256_set1_ps(glm::abs(frustum.planes[p].y));
+        abs_z[p] = _mm256_set1_ps(glm::abs(frustum.planes[p].z));
+    }
+
+    for (; i + 8 <= end; i += 8)
+    {
+        __m256 x = _mm256_loadu_ps(cx + i);
+        __m256 y = _mm256_loadu_ps(cy + i);
+        __m256 z = _mm256_loadu_ps(cz + i);
+        __m256 extent_x = _mm256_loadu_ps(ex + i);
+        __m256 extent_y = _mm256_loadu_ps(ey + i);
+        __m256 extent_z = _mm256_loadu_ps(ez + i);
+
+        __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (int p = 0; p < Frustum::PLANE_COUNT; ++p)
+        {
+            __m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(plane_x[p], x), _mm256_mul_ps(plane_y[p], y)),
+                _mm256_add_ps(_mm256_mul_ps(plane_z[p], z), plane_w[p]));
+            __m256 projected_extent = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(abs_x[p], extent_x),
+                _mm256_mul_ps(abs_y[p], extent_y)), _mm256_mul_ps(abs_z[p], extent_z));
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, _mm256_xor_ps(projected_extent, sign_bit),
+                _CMP_GE_OQ));
+        }
+
+        visible_count = Compact<8>(_mm256_movemask_ps(inside), i, visible_indices, visible_count);
+    }
+
+    return visible_count;
+}
+}   // namespace Ogle
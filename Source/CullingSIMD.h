@@ -0,0 +1,35 @@
+#ifndef CULLING_SIMD_H
+
+#include "Culling.h"
+
+// Internal to the culling functions, shared between Culling.cpp and CullingAVX.cpp
+namespace Ogle
+{
+// Note: The compaction stores every candidate index and only advances the output for the visible ones, which
+// avoids a branch per object. It never writes past the last visible index + 1, which is within bounds.
+// Static so the AVX compiled copy can't replace the other one at link time.
+template <unsigned int WIDTH>
+static inline unsigned int Compact(int mask, unsigned int first, unsigned int* visible_indices, unsigned int count)
+{
+    for (unsigned int lane = 0; lane < WIDTH; ++lane)
+    {
+        visible_indices[count] = first + lane;
+        count += (mask >> lane) & 1;
+    }
+    return count;
+}
+
+#ifdef OGLE_CULLING_AVX
+// In CullingAVX.cpp, the only file compiled with AVX enabled, so only call these if the CPU supports it. They test 8
+// volumes at a time from i while at least 8 are left before end, advance i past them and return the visible count.
+// Note: Only raw pointers go in, calling inline functions of other headers from there could make the linker keep
+// their AVX compiled copies for everyone.
+unsigned int CullSpheresAVX(const Frustum& frustum, const float* cx, const float* cy, const float* cz, const float* r,
+    unsigned int& i, unsigned int end, unsigned int* visible_indices);
+unsigned int CullBoxesAVX(const Frustum& frustum, const float* cx, const float* cy, const float* cz, const float* ex,
+    const float* ey, const float* ez, unsigned int& i, unsigned int end, unsigned int* visible_indices);
+#endif
+}   // namespace Ogle
+
+#define CULLING_SIMD_H
+#endif
@@ -0,0 +1,163 @@
+#include "FrameCapture.h"
+
+#include <stb_image_write.h>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+namespace Ogle
+{
+static const int FRAME_CAPTURE_CHANNELS = 3;
+
+FrameCapture::FrameCapture(JobSystem& jobs_, const std::string& path_pattern_) : jobs(jobs_),
+    path_pattern(path_pattern_)
+{
+    stbi_flip_vertically_on_write(1);
+}
+
+FrameCapture::~FrameCapture()
+{
+    Flush();
+    for (Slot& slot : slots)
+        Release(slot);
+}
+
+void FrameCapture::Capture(unsigned int width, unsigned int height)
+{
+    // Minimized, there is nothing to read
+    if (width != 0 && height != 0)
+    {
+        capture_width = width;
+        capture_height = height;
+    }
+
+    Poll();
+
+    if (width == 0 || height == 0)
+        return;
+
+    Slot& slot = slots[next_slot];
+    if (slot.state.load(std::memory_order_acquire) != SlotState::Free)
+    {
+        ++dropped_frame_count;
+        return;
+    }
+
+    // Lazily, Poll() released it if it had another size, so a resize never waits for the frames in flight
+    if (!slot.buffer)
+        Allocate(slot, width, height);
+
+    // RGB, the back buffer's alpha is whatever blending (e.g. ImGui's) left there and would make the image
+    // partly transparent. Tightly packed, rows of 3 byte pixels aren't 4 byte aligned.
+    GLint pack_alignment;
+    glGetIntegerv(GL_PACK_ALIGNMENT, &pack_alignment);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+    glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    glPixelStorei(GL_PACK_ALIGNMENT, pack_alignment);
+
+    slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    slot.index = captured_frame_count++;
+    slot.state.store(SlotState::Reading, std::memory_order_release);
+
+    next_slot = (next_slot + 1) % RING_SIZE;
+}
+
+void FrameCapture::Poll()
+{
+    for (Slot& slot : slots)
+    {
+        SlotState state = slot.state.load(std::memory_order_acquire);
+
+        // Once drained, buffers of an old size are released, the next Capture() into the slot allocates a new one
+        if (state == SlotState::Free && slot.buffer && (slot.width != capture_width || slot.height != capture_height))
+            Release(slot);
+
+        if (state != SlotState::Reading)
+            continue;
+
+        GLenum result = glClientWaitSync(slot.fence, 0, 0);
+        if (result != GL_ALREADY_SIGNALED && result != GL_CONDITION_SATISFIED)
+            continue;
+
+        glDeleteSync(slot.fence);
+        slot.fence = nullptr;
+
+        slot.state.store(SlotState::Encoding, std::memory_order_release);
+        Slot* slot_pointer = &slot;
+        jobs.Submit(encode_jobs, [this, slot_pointer]() { Encode(*slot_pointer); });
+    }
+}
+
+void FrameCapture::Flush()
+{
+    for (Slot& slot : slots)
+    {
+        if (slot.state.load(std::memory_order_acquire) == SlotState::Reading)
+            glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+    }
+
+    Poll();
+    jobs.Wait(encode_jobs);
+}
+
+void FrameCapture::Allocate(Slot& slot, unsigned int width, unsigned int height)
+{
+    const GLsizeiptr size = GLsizeiptr(width) * height * FRAME_CAPTURE_CHANNELS;
+    const GLbitfield flags = GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+    glCreateBuffers(1, &slot.buffer);
+    glNamedBufferStorage(slot.buffer, size, nullptr, flags | GL_CLIENT_STORAGE_BIT);
+    slot.mapped = (const unsigned char*)glMapNamedBufferRange(slot.buffer, 0, size, flags);
+
+    slot.width = width;
+    slot.height = height;
+}
+
+void FrameCapture::Release(Slot& slot)
+{
+    if (!slot.buffer)
+        return;
+
+    glUnmapNamedBuffer(slot.buffer);
+    glDeleteBuffers(1, &slot.buffer);
+    slot.buffer = 0;
+    slot.mapped = nullptr;
+    slot.width = 0;
+    slot.height = 0;
+}
+
+void FrameCapture::Encode(Slot& slot)
+{
+    const int width = (int)slot.width;
+    const int height = (int)slot.height;
+    const int stride = width * FRAME_CAPTURE_CHANNELS;
+
+    // Copy the pixels out first, so the buffer can be reused while encoding
+    std::vector<unsigned char> pixels(size_t(stride) * height);
+    memcpy(pixels.data(), slot.mapped, pixels.size());
+    unsigned int index = slot.index;
+    slot.state.store(SlotState::Free, std::memory_order_release);
+
+    char path[512];
+    snprintf(path, sizeof(path), path_pattern.c_str(), index);
+
+    const char* extension = strrchr(path, '.');
+    int success = 0;
+    if (extension && strcmp(extension, ".bmp") == 0)
+        success = stbi_write_bmp(path, width, height, FRAME_CAPTURE_CHANNELS, pixels.data());
+    else if (extension && strcmp(extension, ".tga") == 0)
+        success = stbi_write_tga(path, width, height, FRAME_CAPTURE_CHANNELS, pixels.data());
+    else if (extension && (strcmp(extension, ".jpg") == 0 || strcmp(extension, ".jpeg") == 0))
+        success = stbi_write_jpg(path, width, height, FRAME_CAPTURE_CHANNELS, pixels.data(), 95);
+    else
+        success = stbi_write_png(path, width, height, FRAME_CAPTURE_CHANNELS, pixels.data(), stride);
+
+    if (!success)
+        std::cout << "Failed to write frame capture: " << path << std::endl;
+}
+}   // namespace Ogle
@@ -0,0 +1,75 @@
+#ifndef FRAME_CAPTURE_H
+
+#include "JobSystem.h"
+
+#include <glad/glad.h>
+#include <atomic>
+#include <string>
+
+namespace Ogle
+{
+// Captures frames without stalling: the read framebuffer gets copied into one of RING_SIZE persistently mapped pixel
+// pack buffers guarded by a fence, and only once a later frame sees the fence signaled a job copies the pixels out
+// and encodes them with stb_image_write. When every buffer is still in flight the frame is dropped instead of
+// waiting. All methods except the encoding jobs must be called on the thread owning the GL context.
+struct FrameCapture
+{
+    static constexpr unsigned int RING_SIZE = 4;
+
+    // path_pattern is a printf pattern taking the capture index, its extension (.png, .bmp, .tga or .jpg) picks the
+    // format. Note that this sets stb_image_write's global vertical flip, because GL rows are stored bottom up.
+    FrameCapture(JobSystem& jobs_, const std::string& path_pattern_);
+    ~FrameCapture();
+
+    // Queues a readback of the currently bound read framebuffer, call after rendering and before swapping
+    void Capture(unsigned int width, unsigned int height);
+
+    // Hands finished readbacks over to the encoding jobs, Capture() calls it as well
+    void Poll();
+
+    // Blocks until every queued frame is written
+    void Flush();
+
+    inline unsigned int GetCapturedFrameCount() const { return captured_frame_count; }
+    inline unsigned int GetDroppedFrameCount() const { return dropped_frame_count; }
+
+private:
+    enum class SlotState
+    {
+        Free,
+        Reading,
+        Encoding
+    };
+
+    struct Slot
+    {
+        GLuint buffer = 0;
+        const unsigned char* mapped = nullptr;
+        GLsync fence = nullptr;
+        unsigned int width = 0;     // Of the buffer, and so of the frame captured into it
+        unsigned int height = 0;
+        unsigned int index = 0;
+        std::atomic<SlotState> state{ SlotState::Free };
+    };
+
+    void Allocate(Slot& slot, unsigned int width, unsigned int height);
+    void Release(Slot& slot);
+    void Encode(Slot& slot);
+
+    JobSystem& jobs;
+    JobGroup encode_jobs;
+    std::string path_pattern;
+
+    Slot slots[RING_SIZE];
+    unsigned int next_slot = 0;
+    // Latest non-empty size passed to Capture()
+    unsigned int capture_width = 0;
+    unsigned int capture_height = 0;
+
+    unsigned int captured_frame_count = 0;
+    unsigned int dropped_frame_count = 0;
+};
+}   // namespace Ogle
+
+#define FRAME_CAPTURE_H
+#endif
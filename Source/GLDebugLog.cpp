@@ -0,0 +1,266 @@
+#include "GLDebugLog.h"
+
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <iostream>
+
+namespace Ogle
+{
+static double GetSeconds()
+{
+    using namespace std::chrono;
+    return duration<double>(steady_clock::now().time_since_epoch()).count();
+}
+
+GLDebugLog::~GLDebugLog()
+{
+    Stop();
+}
+
+void GLDebugLog::Start(GLenum min_severity_, bool break_on_error_)
+{
+    min_severity = min_severity_;
+    break_on_error = break_on_error_;
+
+    slots = new Slot[CAPACITY];
+    for (unsigned int i = 0; i < CAPACITY; ++i)
+        slots[i].sequence.store(i, std::memory_order_relaxed);
+
+    glEnable(GL_DEBUG_OUTPUT);
+    if (break_on_error)
+        glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+    else
+        glDisable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+
+    glDebugMessageCallback(Callback, this);
+
+    // Let the driver skip generating whatever would be filtered out anyway
+    const GLenum severities[] = { GL_DEBUG_SEVERITY_NOTIFICATION, GL_DEBUG_SEVERITY_LOW, GL_DEBUG_SEVERITY_MEDIUM,
+        GL_DEBUG_SEVERITY_HIGH };
+    for (GLenum severity : severities)
+    {
+        GLboolean enabled = GetSeverityRank(severity) >= GetSeverityRank(min_severity) ? GL_TRUE : GL_FALSE;
+        glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, severity, 0, nullptr, enabled);
+    }
+
+    stopping = false;
+    log_thread = std::thread(&GLDebugLog::LogThreadMain, this);
+}
+
+void GLDebugLog::Stop()
+{
+    if (!log_thread.joinable())
+        return;
+
+    glDebugMessageCallback(nullptr, nullptr);
+
+    {
+        std::lock_guard<std::mutex> lock(stop_mutex);
+        stopping = true;
+    }
+    stop_condition.notify_all();
+    log_thread.join();
+
+    delete[] slots;
+    slots = nullptr;
+}
+
+void GLDebugLog::EndFrame()
+{
+    frame_performance_warning_count = performance_warning_count.exchange(0, std::memory_order_relaxed);
+}
+
+unsigned int GLDebugLog::GetSeverityRank(GLenum severity)
+{
+    switch (severity)
+    {
+        case GL_DEBUG_SEVERITY_HIGH: return 3;
+        case GL_DEBUG_SEVERITY_MEDIUM: return 2;
+        case GL_DEBUG_SEVERITY_LOW: return 1;
+        default: return 0;
+    }
+}
+
+void APIENTRY GLDebugLog::Callback(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length,
+    const GLchar* message, const void* user_param)
+{
+    GLDebugLog* log = (GLDebugLog*)user_param;
+
+    if (type == GL_DEBUG_TYPE_PERFORMANCE)
+        log->performance_warning_count.fetch_add(1, std::memory_order_relaxed);
+
+    if (GetSeverityRank(severity) < GetSeverityRank(log->min_severity))
+        return;
+
+    if (!log->TryPush(source, type, id, severity, length, message))
+        log->dropped_message_count.fetch_add(1, std::memory_order_relaxed);
+
+    // The printed message comes later from the background thread, with debug_break_on_error the callback runs
+    // synchronously inside the failing GL call, so the debugger's call stack shows where it came from
+    if (log->break_on_error && type == GL_DEBUG_TYPE_ERROR && severity == GL_DEBUG_SEVERITY_HIGH)
+    {
+#ifdef _WIN32
+        __debugbreak();
+#else
+        raise(SIGTRAP);
+#endif
+    }
+}
+
+bool GLDebugLog::TryPush(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length,
+    const GLchar* text)
+{
+    Slot* slot;
+    size_t position = enqueue_position.load(std::memory_order_relaxed);
+    while (true)
+    {
+        slot = &slots[position & (CAPACITY - 1)];
+        size_t sequence = slot->sequence.load(std::memory_order_acquire);
+        ptrdiff_t difference = (ptrdiff_t)sequence - (ptrdiff_t)position;
+
+        if (difference == 0)
+        {
+            if (enqueue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                break;
+        }
+        else if (difference < 0)
+        {
+            // Full
+            return false;
+        }
+        else
+        {
+            position = enqueue_position.load(std::memory_order_relaxed);
+        }
+    }
+
+    Message& message = slot->message;
+    message.source = source;
+    message.type = type;
+    message.severity = severity;
+    message.id = id;
+
+    size_t text_length = length >= 0 ? (size_t)length : strlen(text);
+    if (text_length >= MAX_MESSAGE_LENGTH)
+        text_length = MAX_MESSAGE_LENGTH - 1;
+    memcpy(message.text, text, text_length);
+    message.text[text_length] = '\0';
+
+    slot->sequence.store(position + 1, std::memory_order_release);
+    return true;
+}
+
+bool GLDebugLog::TryPop(Message& message)
+{
+    Slot* slot = &slots[dequeue_position & (CAPACITY - 1)];
+    if (slot->sequence.load(std::memory_order_acquire) != dequeue_position + 1)
+        return false;
+
+    message = slot->message;
+    slot->sequence.store(dequeue_position + CAPACITY, std::memory_order_release);
+    ++dequeue_position;
+
+    return true;
+}
+
+void GLDebugLog::LogThreadMain()
+{
+    std::unique_lock<std::mutex> lock(stop_mutex);
+    while (!stopping)
+    {
+        stop_condition.wait_for(lock, std::chrono::milliseconds(50));
+
+        lock.unlock();
+        Drain(false);
+        lock.lock();
+    }
+
+    Drain(true);
+}
+
+void GLDebugLog::Drain(bool report_all_repeats)
+{
+    double now = GetSeconds();
+    bool printed = false;
+
+    Message message;
+    while (TryPop(message))
+    {
+        MessageStats& stats = message_stats[((unsigned long long)message.source << 32) | message.id];
+        if (stats.count++ == 0)
+        {
+            Print(message);
+            stats.reported_count = 1;
+            stats.last_report_time = now;
+            printed = true;
+        }
+    }
+
+    for (auto& it : message_stats)
+    {
+        MessageStats& stats = it.second;
+        if (stats.count == stats.reported_count)
+            continue;
+
+        if (report_all_repeats || now - stats.last_report_time >= 1.0)
+        {
+            std::cout << "Debug Message (" << (GLuint)it.first << ") repeated " << stats.count - stats.reported_count
+                << " more time(s), " << stats.count << " in total\n";
+            stats.reported_count = stats.count;
+            stats.last_report_time = now;
+            printed = true;
+        }
+    }
+
+    unsigned int dropped = dropped_message_count.exchange(0, std::memory_order_relaxed);
+    if (dropped > 0)
+    {
+        std::cout << "Warning: " << dropped << " debug message(s) dropped, the queue was full\n";
+        printed = true;
+    }
+
+    if (printed)
+        std::cout.flush();
+}
+
+void GLDebugLog::Print(const Message& message) const
+{
+    const char* source = "Unknown";
+    switch (message.source)
+    {
+        case GL_DEBUG_SOURCE_API: source = "API"; break;
+        case GL_DEBUG_SOURCE_WINDOW_SYSTEM: source = "Window System"; break;
+        case GL_DEBUG_SOURCE_SHADER_COMPILER: source = "Shader Compiler"; break;
+        case GL_DEBUG_SOURCE_THIRD_PARTY: source = "Third Party"; break;
+        case GL_DEBUG_SOURCE_APPLICATION: source = "Application"; break;
+        case GL_DEBUG_SOURCE_OTHER: source = "Other"; break;
+    }
+
+    const char* type = "Unknown";
+    switch (message.type)
+    {
+        case GL_DEBUG_TYPE_ERROR:               type = "Error"; break;
+        case GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR: type = "Deprecated Behaviour"; break;
+        case GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR:  type = "Undefined Behaviour"; break;
+        case GL_DEBUG_TYPE_PORTABILITY:         type = "Portability"; break;
+        case GL_DEBUG_TYPE_PERFORMANCE:         type = "Performance"; break;
+        case GL_DEBUG_TYPE_MARKER:              type = "Marker"; break;
+        case GL_DEBUG_TYPE_PUSH_GROUP:          type = "Push Group"; break;
+        case GL_DEBUG_TYPE_POP_GROUP:           type = "Pop Group"; break;
+        case GL_DEBUG_TYPE_OTHER:               type = "Other"; break;
+    }
+
+    const char* severity = "unknown";
+    switch (message.severity)
+    {
+        case GL_DEBUG_SEVERITY_HIGH:         severity = "high"; break;
+        case GL_DEBUG_SEVERITY_MEDIUM:       severity = "medium"; break;
+        case GL_DEBUG_SEVERITY_LOW:          severity = "low"; break;
+        case GL_DEBUG_SEVERITY_NOTIFICATION: severity = "notification"; break;
+    }
+
+    std::cout << "Debug Message (" << message.id << "): " << message.text << "\n"
+        << "Source: " << source << ", Type: " << type << ", Severity: " << severity << "\n";
+}
+}   // namespace Ogle
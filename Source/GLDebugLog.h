@@ -0,0 +1,93 @@
+#ifndef GL_DEBUG_LOG_H
+
+#include <glad/glad.h>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+namespace Ogle
+{
+// Receives GL debug messages and logs them from a background thread. The callback only filters by severity and
+// copies the message into a lock-free ring (dropping it when the ring is full), so it stays cheap enough for debug
+// contexts in performance runs. The logging thread prints the first occurrence of every message id and afterwards
+// only how often it repeated, at most once per second.
+struct GLDebugLog
+{
+    static constexpr unsigned int CAPACITY = 1024;   // Must be a power of 2
+    static constexpr unsigned int MAX_MESSAGE_LENGTH = 256;
+
+    ~GLDebugLog();
+
+    // Requires a current debug context. Messages below min_severity are disabled in the driver. With break_on_error
+    // the output is made synchronous and high severity errors break into the debugger inside the offending call.
+    void Start(GLenum min_severity, bool break_on_error);
+    void Stop();
+
+    // Latches the number of performance warnings received since the last call
+    void EndFrame();
+
+    inline unsigned int GetFramePerformanceWarningCount() const { return frame_performance_warning_count; }
+    inline unsigned int GetDroppedMessageCount() const { return dropped_message_count.load(std::memory_order_relaxed); }
+
+    static unsigned int GetSeverityRank(GLenum severity);
+
+private:
+    struct Message
+    {
+        GLenum source;
+        GLenum type;
+        GLenum severity;
+        GLuint id;
+        char text[MAX_MESSAGE_LENGTH];
+    };
+
+    struct Slot
+    {
+        std::atomic<size_t> sequence;
+        Message message;
+    };
+
+    struct MessageStats
+    {
+        unsigned int count = 0;
+        unsigned int reported_count = 0;
+        double last_report_time = 0.0;
+    };
+
+    static void APIENTRY Callback(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length,
+        const GLchar* message, const void* user_param);
+
+    bool TryPush(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length, const GLchar* text);
+    bool TryPop(Message& message);
+
+    void LogThreadMain();
+    void Drain(bool report_all_repeats);
+    void Print(const Message& message) const;
+
+    // Multi-producer (the driver may call back from several threads) single-consumer bounded queue after Dmitry
+    // Vyukov's, every slot carries a sequence number telling whether it's ready to be written or read
+    Slot* slots = nullptr;
+    std::atomic<size_t> enqueue_position{ 0 };
+    size_t dequeue_position = 0;
+
+    std::unordered_map<unsigned long long, MessageStats> message_stats;
+
+    GLenum min_severity = GL_DEBUG_SEVERITY_LOW;
+    bool break_on_error = false;
+
+    std::atomic<unsigned int> dropped_message_count{ 0 };
+    std::atomic<unsigned int> performance_warning_count{ 0 };
+    unsigned int frame_performance_warning_count = 0;
+
+    std::thread log_thread;
+    std::mutex stop_mutex;
+    std::condition_variable stop_condition;
+    bool stopping = false;
+};
+}   // namespace Ogle
+
+#define GL_DEBUG_LOG_H
+#endif
@@ -0,0 +1,720 @@
+#include "GlbModel.h"
+
+#include "MappedFile.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <utility>
+
+namespace Ogle
+{
+static const uint32_t GLB_MAGIC = 0x46546c67;         // "glTF"
+static const uint32_t GLB_CHUNK_JSON = 0x4e4f534a;    // "JSON"
+static const uint32_t GLB_CHUNK_BIN = 0x004e4942;     // "BIN\0"
+
+// Just enough JSON for the glTF scene description, which is small compared to the binary chunk
+struct JsonValue
+{
+    enum class Type { Null, Bool, Number, String, Array, Object };
+
+    const JsonValue& operator[](const char* key) const
+    {
+        for (const auto& member : members)
+        {
+            if (member.first == key)
+                return member.second;
+        }
+        return GetNull();
+    }
+
+    const JsonValue& operator[](size_t index) const
+    {
+        return index < elements.size() ? elements[index] : GetNull();
+    }
+
+    inline bool IsNull() const { return type == Type::Null; }
+    inline size_t GetSize() const { return type == Type::Array ? elements.size() : members.size(); }
+    inline double GetNumber(double fallback = 0.0) const { return type == Type::Number ? number : fallback; }
+    inline unsigned int GetIndex(unsigned int fallback = ~0u) const
+    {
+        return type == Type::Number && number >= 0.0 ? (unsigned int)number : fallback;
+    }
+
+    static const JsonValue& GetNull()
+    {
+        static const JsonValue null;
+        return null;
+    }
+
+    Type type = Type::Null;
+    bool boolean = false;
+    double number = 0.0;
+    std::string string;
+    std::vector<JsonValue> elements;
+    std::vector<std::pair<std::string, JsonValue>> members;
+};
+
+struct JsonParser
+{
+    JsonParser(const char* begin, const char* end_) : c(begin), end(end_) {}
+
+    bool Parse(JsonValue& value, unsigned int depth = 0)
+    {
+        SkipWhitespace();
+        if (c == end || depth > 64)
+            return false;
+
+        switch (*c)
+        {
+            case '{':
+            {
+                value.type = JsonValue::Type::Object;
+                ++c;
+                SkipWhitespace();
+                if (c < end && *c == '}')
+                {
+                    ++c;
+                    return true;
+                }
+
+                while (true)
+                {
+                    std::pair<std::string, JsonValue> member;
+                    SkipWhitespace();
+                    if (!ParseString(member.first))
+                        return false;
+
+                    SkipWhitespace();
+                    if (c == end || *c++ != ':')
+                        return false;
+
+                    if (!Parse(member.second, depth + 1))
+                        return false;
+                    value.members.push_back(std::move(member));
+
+                    SkipWhitespace();
+                    if (c == end)
+                        return false;
+                    if (*c == ',')
+                    {
+                        ++c;
+                        continue;
+                    }
+                    return *c++ == '}';
+                }
+            }
+
+            case '[':
+            {
+                value.type = JsonValue::Type::Array;
+                ++c;
+                SkipWhitespace();
+                if (c < end && *c == ']')
+                {
+                    ++c;
+                    return true;
+                }
+
+                while (true)
+                {
+                    value.elements.emplace_back();
+                    if (!Parse(value.elements.back(), depth + 1))
+                        return false;
+
+                    SkipWhitespace();
+                    if (c == end)
+                        return false;
+                    if (*c == ',')
+                    {
+                        ++c;
+                        continue;
+                    }
+                    return *c++ == ']';
+                }
+            }
+
+            case '"':
+            {
+                value.type = JsonValue::Type::String;
+                return ParseString(value.string);
+            }
+
+            case 't':
+            case 'f':
+            {
+                value.type = JsonValue::Type::Bool;
+                value.boolean = *c == 't';
+                return ParseLiteral(value.boolean ? "true" : "false");
+            }
+
+            case 'n':
+            {
+                value.type = JsonValue::Type::Null;
+                return ParseLiteral("null");
+            }
+
+            default:
+            {
+                // Note: strtod is locale dependent, but this is only the small scene description
+                char* number_end;
+                std::string number(c, std::min<size_t>(end - c, 64));
+                value.type = JsonValue::Type::Number;
+                value.number = strtod(number.c_str(), &number_end);
+                if (number_end == number.c_str())
+                    return false;
+                c += number_end - number.c_str();
+                return true;
+            }
+        }
+    }
+
+private:
+    void SkipWhitespace()
+    {
+        while (c < end && (*c == ' ' || *c == '\t' || *c == '\n' || *c == '\r'))
+            ++c;
+    }
+
+    bool ParseLiteral(const char* literal)
+    {
+        size_t length = strlen(literal);
+        if (size_t(end - c) < length || memcmp(c, literal, length) != 0)
+            return false;
+        c += length;
+        return true;
+    }
+
+    bool ParseString(std::string& result)
+    {
+        if (c == end || *c++ != '"')
+            return false;
+
+        while (c < end && *c != '"')
+        {
+            if (*c != '\\')
+            {
+                result += *c++;
+                continue;
+            }
+
+            if (++c == end)
+                return false;
+
+            switch (*c++)
+            {
+                case 'b': result += '\b'; break;
+                case 'f': result += '\f'; break;
+                case 'n': result += '\n'; break;
+                case 'r': result += '\r'; break;
+                case 't': result += '\t'; break;
+                case 'u':
+                {
+                    if (end - c < 4)
+                        return false;
+
+                    // Todo: Surrogate pairs
+                    unsigned int code_point = (unsigned int)strtoul(std::string(c, 4).c_str(), nullptr, 16);
+                    c += 4;
+
+                    if (code_point < 0x80)
+                    {
+                        result += char(code_point);
+                    }
+                    else if (code_point < 0x800)
+                    {
+                        result += char(0xc0 | (code_point >> 6));
+                        result += char(0x80 | (code_point & 0x3f));
+                    }
+                    else
+                    {
+                        result += char(0xe0 | (code_point >> 12));
+                        result += char(0x80 | ((code_point >> 6) & 0x3f));
+                        result += char(0x80 | (code_point & 0x3f));
+                    }
+                } break;
+
+                default: result += c[-1]; break;
+            }
+        }
+
+        if (c == end)
+            return false;
+
+        ++c;
+        return true;
+    }
+
+    const char* c;
+    const char* end;
+};
+
+struct GlbBufferView
+{
+    const unsigned char* data;
+    size_t size;
+    GLsizei stride;
+};
+
+static GLint GetAccessorDims(const std::string& type)
+{
+    if (type == "SCALAR") return 1;
+    if (type == "VEC2") return 2;
+    if (type == "VEC3") return 3;
+    if (type == "VEC4") return 4;
+    return 0;
+}
+
+static size_t GetComponentSize(GLenum component_type)
+{
+    switch (component_type)
+    {
+        case GL_BYTE:
+        case GL_UNSIGNED_BYTE:
+            return 1;
+        case GL_SHORT:
+        case GL_UNSIGNED_SHORT:
+            return 2;
+        case GL_UNSIGNED_INT:
+        case GL_FLOAT:
+            return 4;
+        default:
+            return 0;
+    }
+}
+
+// Scans the indices, they may be unaligned within the buffer view
+static uint32_t GetMaxGlbIndex(const unsigned char* indices, size_t count, GLenum index_type)
+{
+    uint32_t result = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        uint32_t index;
+        if (index_type == GL_UNSIGNED_BYTE)
+        {
+            index = indices[i];
+        }
+        else if (index_type == GL_UNSIGNED_SHORT)
+        {
+            uint16_t index_16;
+            memcpy(&index_16, indices + 2 * i, 2);
+            index = index_16;
+        }
+        else
+        {
+            memcpy(&index, indices + 4 * i, 4);
+        }
+
+        result = std::max(result, index);
+    }
+    return result;
+}
+
+static float GetArrayNumber(const JsonValue& array, size_t index, float fallback)
+{
+    return (float)array[index].GetNumber(fallback);
+}
+
+// Either the node's matrix or translation * rotation * scale
+static glm::mat4 GetNodeTransform(const JsonValue& node)
+{
+    glm::mat4 result(1.f);
+
+    const JsonValue& matrix = node["matrix"];
+    if (matrix.GetSize() == 16)
+    {
+        // Column major, like glm
+        for (int column = 0; column < 4; ++column)
+        {
+            for (int row = 0; row < 4; ++row)
+                result[column][row] = GetArrayNumber(matrix, column * 4 + row, 0.f);
+        }
+        return result;
+    }
+
+    const JsonValue& translation = node["translation"];
+    const JsonValue& rotation = node["rotation"];
+    const JsonValue& scale = node["scale"];
+
+    const float x = GetArrayNumber(rotation, 0, 0.f);
+    const float y = GetArrayNumber(rotation, 1, 0.f);
+    const float z = GetArrayNumber(rotation, 2, 0.f);
+    const float w = GetArrayNumber(rotation, 3, 1.f);
+    const float scale_x = GetArrayNumber(scale, 0, 1.f);
+    const float scale_y = GetArrayNumber(scale, 1, 1.f);
+    const float scale_z = GetArrayNumber(scale, 2, 1.f);
+
+    // The columns of the rotation matrix of the unit quaternion, scaled
+    result[0][0] = (1.f - 2.f * (y * y + z * z)) * scale_x;
+    result[0][1] = 2.f * (x * y + z * w) * scale_x;
+    result[0][2] = 2.f * (x * z - y * w) * scale_x;
+
+    result[1][0] = 2.f * (x * y - z * w) * scale_y;
+    result[1][1] = (1.f - 2.f * (x * x + z * z)) * scale_y;
+    result[1][2] = 2.f * (y * z + x * w) * scale_y;
+
+    result[2][0] = 2.f * (x * z + y * w) * scale_z;
+    result[2][1] = 2.f * (y * z - x * w) * scale_z;
+    result[2][2] = (1.f - 2.f * (x * x + y * y)) * scale_z;
+
+    result[3][0] = GetArrayNumber(translation, 0, 0.f);
+    result[3][1] = GetArrayNumber(translation, 1, 0.f);
+    result[3][2] = GetArrayNumber(translation, 2, 0.f);
+    return result;
+}
+
+static std::string GetDirectory(const char* path)
+{
+    std::string result(path);
+    size_t separator = result.find_last_of("/\\");
+    return separator == std::string::npos ? std::string() : result.substr(0, separator + 1);
+}
+
+GlbModel* GlbModel::CreateFromFile(const char* path)
+{
+    MappedFile* file = MappedFile::Open(path);
+    if (!file)
+        return nullptr;
+
+    const unsigned char* data = (const unsigned char*)file->GetData();
+    const size_t size = file->GetSize();
+
+    // Magic, version, total length
+    uint32_t header[3] = {};
+    if (size >= sizeof(header))
+        memcpy(header, data, sizeof(header));
+
+    if (header[0] != GLB_MAGIC || header[1] != 2)
+    {
+        std::cout << "Not a glTF 2.0 binary: " << path << std::endl;
+        delete file;
+        return nullptr;
+    }
+
+    // Chunks: the JSON first, then optionally the binary buffer
+    const unsigned char* json = nullptr;
+    size_t json_size = 0;
+    const unsigned char* bin = nullptr;
+    size_t bin_size = 0;
+    for (size_t offset = sizeof(header); offset + 8 <= size;)
+    {
+        uint32_t chunk_header[2];
+        memcpy(chunk_header, data + offset, sizeof(chunk_header));
+        offset += sizeof(chunk_header);
+        if (chunk_header[0] > size - offset)
+            break;
+
+        if (chunk_header[1] == GLB_CHUNK_JSON && !json)
+        {
+            json = data + offset;
+            json_size = chunk_header[0];
+        }
+        else if (chunk_header[1] == GLB_CHUNK_BIN && !bin)
+        {
+            bin = data + offset;
+            bin_size = chunk_header[0];
+        }
+
+        // Chunks are 4 byte aligned
+        offset += (chunk_header[0] + 3) & ~size_t(3);
+    }
+
+    JsonValue gltf;
+    JsonParser parser((const char*)json, (const char*)json + json_size);
+    if (!json || !parser.Parse(gltf))
+    {
+        std::cout << "Failed to parse glTF JSON: " << path << std::endl;
+        delete file;
+        return nullptr;
+    }
+
+    const std::string directory = GetDirectory(path);
+    std::vector<MappedFile*> external_files;
+
+    auto fail = [&](GlbModel* model, const char* message) -> GlbModel*
+    {
+        std::cout << message << ": " << path << std::endl;
+        delete model;
+        for (MappedFile* external_file : external_files)
+            delete external_file;
+        delete file;
+        return nullptr;
+    };
+
+    // Resolve buffers, then buffer views to memory ranges
+    std::vector<std::pair<const unsigned char*, size_t>> buffers;
+    const JsonValue& json_buffers = gltf["buffers"];
+    for (size_t i = 0; i < json_buffers.GetSize(); ++i)
+    {
+        const JsonValue& uri = json_buffers[i]["uri"];
+        if (uri.IsNull())
+        {
+            buffers.emplace_back(bin, bin_size);
+        }
+        else if (uri.string.compare(0, 5, "data:") == 0)
+        {
+            return fail(nullptr, "Data URIs are not supported");
+        }
+        else
+        {
+            MappedFile* external_file = MappedFile::Open((directory + uri.string).c_str());
+            if (!external_file)
+                return fail(nullptr, "Failed to open glTF buffer");
+
+            external_files.push_back(external_file);
+            buffers.emplace_back((const unsigned char*)external_file->GetData(), external_file->GetSize());
+        }
+    }
+
+    std::vector<GlbBufferView> buffer_views;
+    const JsonValue& json_buffer_views = gltf["bufferViews"];
+    for (size_t i = 0; i < json_buffer_views.GetSize(); ++i)
+    {
+        const JsonValue& json_view = json_buffer_views[i];
+        unsigned int buffer = json_view["buffer"].GetIndex();
+        size_t offset = (size_t)json_view["byteOffset"].GetNumber();
+        size_t length = (size_t)json_view["byteLength"].GetNumber();
+
+        if (buffer >= buffers.size() || !buffers[buffer].first || offset > buffers[buffer].second ||
+            length > buffers[buffer].second - offset)
+        {
+            return fail(nullptr, "Invalid glTF buffer view");
+        }
+
+        buffer_views.push_back({ buffers[buffer].first + offset, length, (GLsizei)json_view["byteStride"].GetNumber() });
+    }
+
+    GlbModel* result = new GlbModel;
+
+    // Images are either stored in a buffer view or a file next to the model
+    const JsonValue& json_images = gltf["images"];
+    for (size_t i = 0; i < json_images.GetSize(); ++i)
+    {
+        const JsonValue& json_image = json_images[i];
+        Texture2D* texture = nullptr;
+
+        unsigned int view = json_image["bufferView"].GetIndex();
+        if (view < buffer_views.size())
+            texture = Texture2D::CreateFromMemory(buffer_views[view].data, buffer_views[view].size);
+        else if (!json_image["uri"].IsNull() && json_image["uri"].string.compare(0, 5, "data:") != 0)
+            texture = Texture2D::CreateFromFile((directory + json_image["uri"].string).c_str());
+
+        result->textures.push_back(texture);
+    }
+
+    auto get_texture = [&](const JsonValue& texture_info) -> Texture2D*
+    {
+        unsigned int image = gltf["textures"][texture_info["index"].GetIndex()]["source"].GetIndex();
+        return image < result->textures.size() ? result->textures[image] : nullptr;
+    };
+
+    // One VertexBuffer per buffer view used by vertex attributes, created on first use
+    std::vector<VertexBuffer*> view_vertex_buffers(buffer_views.size(), nullptr);
+
+    static const char* ATTRIBUTE_NAMES[GLB_ATTRIBUTE_COUNT] =
+    {
+        "POSITION", "NORMAL", "TEXCOORD_0", "TANGENT", "COLOR_0", "JOINTS_0", "WEIGHTS_0"
+    };
+
+    const JsonValue& accessors = gltf["accessors"];
+    const JsonValue& meshes = gltf["meshes"];
+    std::vector<unsigned int> mesh_first_primitives(meshes.GetSize() + 1);
+    for (size_t mesh = 0; mesh < meshes.GetSize(); ++mesh)
+    {
+        mesh_first_primitives[mesh] = (unsigned int)result->primitives.size();
+
+        const JsonValue& json_primitives = meshes[mesh]["primitives"];
+        for (size_t i = 0; i < json_primitives.GetSize(); ++i)
+        {
+            const JsonValue& json_primitive = json_primitives[i];
+
+            GlbPrimitive primitive = {};
+            primitive.mode = (GLenum)json_primitive["mode"].GetNumber(GL_TRIANGLES);
+            primitive.mesh = (unsigned int)mesh;
+
+            VertexAttribs attribs[GLB_ATTRIBUTE_COUNT] = {};
+            size_t attrib_counts[GLB_ATTRIBUTE_COUNT] = {};
+            for (unsigned int attribute = 0; attribute < GLB_ATTRIBUTE_COUNT; ++attribute)
+            {
+                const JsonValue& accessor = accessors[json_primitive["attributes"][ATTRIBUTE_NAMES[attribute]].GetIndex()];
+                if (accessor.IsNull())
+                    continue;
+
+                unsigned int view = accessor["bufferView"].GetIndex();
+                GLint dims = GetAccessorDims(accessor["type"].string);
+                GLenum component_type = (GLenum)accessor["componentType"].GetNumber();
+                size_t component_size = GetComponentSize(component_type);
+                size_t offset = (size_t)accessor["byteOffset"].GetNumber();
+                size_t count = (size_t)accessor["count"].GetNumber();
+
+                if (view >= buffer_views.size() || dims == 0 || component_size == 0 || !accessor["sparse"].IsNull())
+                {
+                    std::cout << "Skipping unsupported glTF accessor for " << ATTRIBUTE_NAMES[attribute] << std::endl;
+                    continue;
+                }
+
+                const GlbBufferView& buffer_view = buffer_views[view];
+                size_t element_size = dims * component_size;
+                size_t stride = buffer_view.stride ? buffer_view.stride : element_size;
+                if (count > 0 && (offset > buffer_view.size || (count - 1) * stride + element_size > buffer_view.size - offset))
+                {
+                    return fail(result, "glTF accessor out of bounds");
+                }
+
+                if (!view_vertex_buffers[view])
+                {
+                    view_vertex_buffers[view] = new VertexBuffer(buffer_view.data, buffer_view.size);
+                    result->vertex_buffers.push_back(view_vertex_buffers[view]);
+                }
+
+                VertexAttribs& attrib = attribs[attribute];
+                attrib.dims = dims;
+                attrib.offset = offset;
+                attrib.type = component_type;
+                attrib.normalized = accessor["normalized"].boolean ? GL_TRUE : GL_FALSE;
+                attrib.integer = attribute == GLB_JOINTS_0;
+                attrib.stride = buffer_view.stride;
+                attrib.buffer = view_vertex_buffers[view];
+                attrib_counts[attribute] = count;
+
+                if (attribute == GLB_POSITION)
+                    primitive.vertex_count = (unsigned int)count;
+            }
+
+            if (attribs[GLB_POSITION].dims == 0)
+            {
+                return fail(result, "glTF primitive without positions");
+            }
+
+            // The GPU would fetch past the end of shorter accessors
+            for (unsigned int attribute = 0; attribute < GLB_ATTRIBUTE_COUNT; ++attribute)
+            {
+                if (attribs[attribute].dims != 0 && attrib_counts[attribute] < primitive.vertex_count)
+                {
+                    std::cout << "Skipping glTF accessor for " << ATTRIBUTE_NAMES[attribute]
+                        << " with fewer elements than positions" << std::endl;
+                    attribs[attribute] = {};
+                }
+            }
+
+            const JsonValue& index_accessor = accessors[json_primitive["indices"].GetIndex()];
+            if (!index_accessor.IsNull())
+            {
+                unsigned int view = index_accessor["bufferView"].GetIndex();
+                GLenum index_type = (GLenum)index_accessor["componentType"].GetNumber();
+                size_t offset = (size_t)index_accessor["byteOffset"].GetNumber();
+                size_t count = (size_t)index_accessor["count"].GetNumber();
+
+                if (view >= buffer_views.size() || (index_type != GL_UNSIGNED_BYTE && index_type != GL_UNSIGNED_SHORT &&
+                    index_type != GL_UNSIGNED_INT) || offset > buffer_views[view].size ||
+                    count * GetComponentSize(index_type) > buffer_views[view].size - offset)
+                {
+                    return fail(result, "Invalid glTF index accessor");
+                }
+
+                if (count > 0 && GetMaxGlbIndex(buffer_views[view].data + offset, count, index_type) >= primitive.vertex_count)
+                {
+                    return fail(result, "glTF indices out of range");
+                }
+
+                primitive.ibo = new IndexBuffer(buffer_views[view].data + offset, (unsigned int)count, index_type);
+            }
+
+            primitive.vao = new VertexArray(nullptr, primitive.ibo, attribs, GLB_ATTRIBUTE_COUNT, 0);
+
+            unsigned int material = json_primitive["material"].GetIndex();
+            const JsonValue& base_color = gltf["materials"][material]["pbrMetallicRoughness"]["baseColorTexture"];
+            if (!base_color.IsNull())
+                primitive.base_color_texture = get_texture(base_color);
+
+            result->primitives.push_back(primitive);
+        }
+    }
+    mesh_first_primitives[meshes.GetSize()] = (unsigned int)result->primitives.size();
+
+    // Flatten the default scene's node hierarchy, without a scene every node without a parent is a root
+    const JsonValue& json_nodes = gltf["nodes"];
+    std::vector<std::pair<unsigned int, glm::mat4>> node_stack;
+
+    const JsonValue& scene_nodes = gltf["scenes"][gltf["scene"].GetIndex(0)]["nodes"];
+    if (!scene_nodes.IsNull())
+    {
+        for (size_t i = 0; i < scene_nodes.GetSize(); ++i)
+            node_stack.emplace_back(scene_nodes[i].GetIndex(), glm::mat4(1.f));
+    }
+    else
+    {
+        std::vector<bool> is_child(json_nodes.GetSize(), false);
+        for (size_t node = 0; node < json_nodes.GetSize(); ++node)
+        {
+            const JsonValue& children = json_nodes[node]["children"];
+            for (size_t i = 0; i < children.GetSize(); ++i)
+            {
+                if (children[i].GetIndex() < is_child.size())
+                    is_child[children[i].GetIndex()] = true;
+            }
+        }
+
+        for (size_t node = 0; node < json_nodes.GetSize(); ++node)
+        {
+            if (!is_child[node])
+                node_stack.emplace_back((unsigned int)node, glm::mat4(1.f));
+        }
+    }
+
+    // Guards against cycles in invalid files
+    std::vector<bool> visited(json_nodes.GetSize(), false);
+    while (!node_stack.empty())
+    {
+        const unsigned int node = node_stack.back().first;
+        const glm::mat4 parent_world = node_stack.back().second;
+        node_stack.pop_back();
+
+        if (node >= json_nodes.GetSize() || visited[node])
+            continue;
+        visited[node] = true;
+
+        const JsonValue& json_node = json_nodes[node];
+        const glm::mat4 world = parent_world * GetNodeTransform(json_node);
+
+        unsigned int mesh = json_node["mesh"].GetIndex();
+        if (mesh < meshes.GetSize())
+        {
+            GlbNode glb_node;
+            glb_node.world = world;
+            glb_node.mesh = mesh;
+            glb_node.first_primitive = mesh_first_primitives[mesh];
+            glb_node.primitive_count = mesh_first_primitives[mesh + 1] - mesh_first_primitives[mesh];
+            result->nodes.push_back(glb_node);
+        }
+
+        const JsonValue& children = json_node["children"];
+        for (size_t i = 0; i < children.GetSize(); ++i)
+            node_stack.emplace_back(children[i].GetIndex(), world);
+    }
+
+    for (MappedFile* external_file : external_files)
+        delete external_file;
+    delete file;
+
+    return result;
+}
+
+GlbModel::~GlbModel()
+{
+    for (GlbPrimitive& primitive : primitives)
+    {
+        delete primitive.vao;
+        delete primitive.ibo;
+    }
+
+    for (VertexBuffer* vertex_buffer : vertex_buffers)
+        delete vertex_buffer;
+
+    for (Texture2D* texture : textures)
+        delete texture;
+}
+}   // namespace Ogle
@@ -0,0 +1,63 @@
+#ifndef GLB_MODEL_H
+
+#include "Mesh.h"
+#include "Texture2D.h"
+
+#include <glm/glm.hpp>
+#include <vector>
+
+namespace Ogle
+{
+// Attribute locations of the glTF attributes in the VertexArrays
+enum GlbAttribute
+{
+    GLB_POSITION,
+    GLB_NORMAL,
+    GLB_TEXCOORD_0,
+    GLB_TANGENT,
+    GLB_COLOR_0,
+    GLB_JOINTS_0,           // Integer attribute
+    GLB_WEIGHTS_0,
+    GLB_ATTRIBUTE_COUNT
+};
+
+struct GlbPrimitive
+{
+    VertexArray* vao;
+    IndexBuffer* ibo;                   // Null for non-indexed primitives
+    GLenum mode;                        // GL_TRIANGLES, GL_LINES, ...
+    unsigned int vertex_count;
+    unsigned int mesh;                  // Index of the glTF mesh this belongs to
+    Texture2D* base_color_texture;      // May be null
+};
+
+// An instance of a glTF mesh in the scene, its primitives are primitives[first_primitive, + primitive_count)
+struct GlbNode
+{
+    glm::mat4 world;                    // Model matrix, the node's transform concatenated with its parents'
+    unsigned int mesh;
+    unsigned int first_primitive;
+    unsigned int primitive_count;
+};
+
+// glTF 2.0 binary. Every buffer view used by a vertex attribute gets uploaded as is into one VertexBuffer, straight
+// from the memory mapped file, and the VertexArrays reference them with the accessors' offsets, strides and
+// component types, so quantized data stays packed. Index accessors go into IndexBuffers the same way.
+// The default scene's node hierarchy is flattened into world matrices of mesh instances, draw through nodes rather
+// than primitives to place meshes where they belong.
+// Todo: Sparse accessors, data URIs, skins and animations aren't supported.
+struct GlbModel
+{
+    static GlbModel* CreateFromFile(const char* path);
+    ~GlbModel();
+
+    std::vector<GlbPrimitive> primitives;   // Grouped by mesh
+    std::vector<GlbNode> nodes;
+
+    std::vector<VertexBuffer*> vertex_buffers;
+    std::vector<Texture2D*> textures;      // Per glTF image
+};
+}   // namespace Ogle
+
+#define GLB_MODEL_H
+#endif
@@ -0,0 +1,396 @@
+#include "GpuHeap.h"
+
+#include <iostream>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace Ogle
+{
+static const uint32_t SMALL_FLOAT_MANTISSA_BITS = 3;
+static const uint32_t SMALL_FLOAT_MANTISSA_VALUE = 1 << SMALL_FLOAT_MANTISSA_BITS;
+static const uint32_t SMALL_FLOAT_MANTISSA_MASK = SMALL_FLOAT_MANTISSA_VALUE - 1;
+
+static inline uint32_t CountTrailingZeros(uint32_t value)
+{
+#ifdef _MSC_VER
+    unsigned long result;
+    _BitScanForward(&result, value);
+    return result;
+#else
+    return __builtin_ctz(value);
+#endif
+}
+
+static inline uint32_t GetHighestBit(uint32_t value)
+{
+#ifdef _MSC_VER
+    unsigned long result;
+    _BitScanReverse(&result, value);
+    return result;
+#else
+    return 31 - __builtin_clz(value);
+#endif
+}
+
+// Sizes below the mantissa range map to their own bin, the others to exponent and the 3 bits after the highest
+static uint32_t SizeToBinRoundDown(uint32_t size)
+{
+    if (size < SMALL_FLOAT_MANTISSA_VALUE)
+        return size;
+
+    uint32_t mantissa_start = GetHighestBit(size) - SMALL_FLOAT_MANTISSA_BITS;
+    uint32_t exponent = mantissa_start + 1;
+    uint32_t mantissa = (size >> mantissa_start) & SMALL_FLOAT_MANTISSA_MASK;
+    return (exponent << SMALL_FLOAT_MANTISSA_BITS) | mantissa;
+}
+
+// The smallest bin whose blocks all hold at least size
+static uint32_t SizeToBinRoundUp(uint32_t size)
+{
+    if (size < SMALL_FLOAT_MANTISSA_VALUE)
+        return size;
+
+    uint32_t mantissa_start = GetHighestBit(size) - SMALL_FLOAT_MANTISSA_BITS;
+    uint32_t exponent = mantissa_start + 1;
+    uint32_t mantissa = (size >> mantissa_start) & SMALL_FLOAT_MANTISSA_MASK;
+    uint32_t low_bits_mask = (1u << mantissa_start) - 1;
+
+    // A carry out of the mantissa correctly bumps the exponent
+    return ((exponent << SMALL_FLOAT_MANTISSA_BITS) + mantissa) + ((size & low_bits_mask) ? 1 : 0);
+}
+
+OffsetAllocator::OffsetAllocator(uint32_t size_) : size(size_), free_size(size_)
+{
+    for (uint32_t& head : bin_heads)
+        head = NONE;
+
+    if (size > 0)
+        InsertFreeNode(CreateNode(0, size));
+}
+
+OffsetAllocator::Allocation OffsetAllocator::Allocate(uint32_t allocation_size)
+{
+    Allocation result;
+    if (allocation_size == 0)
+        allocation_size = 1;
+
+    const uint32_t min_bin = SizeToBinRoundUp(allocation_size);
+    uint32_t top = min_bin >> SMALL_FLOAT_MANTISSA_BITS;
+    uint32_t bin = NONE;
+
+    // Try the rest of the minimum bin's top level first, then the next used top level
+    if (top < 32 && (used_bins_top & (1u << top)))
+    {
+        uint32_t leaf_mask = used_bins[top] & (0xffu << (min_bin & SMALL_FLOAT_MANTISSA_MASK));
+        if (leaf_mask)
+            bin = (top << SMALL_FLOAT_MANTISSA_BITS) | CountTrailingZeros(leaf_mask);
+    }
+
+    if (bin == NONE)
+    {
+        if (top + 1 >= 32)
+            return result;
+
+        uint32_t top_mask = used_bins_top & (~0u << (top + 1));
+        if (!top_mask)
+            return result;
+
+        top = CountTrailingZeros(top_mask);
+        bin = (top << SMALL_FLOAT_MANTISSA_BITS) | CountTrailingZeros(used_bins[top]);
+    }
+
+    const uint32_t node = bin_heads[bin];
+    RemoveFreeNode(node);
+
+    const uint32_t remainder = nodes[node].size - allocation_size;
+    nodes[node].size = allocation_size;
+    nodes[node].used = true;
+    free_size -= allocation_size;
+
+    if (remainder > 0)
+    {
+        // Note: CreateNode() can reallocate nodes
+        const uint32_t split = CreateNode(nodes[node].offset + allocation_size, remainder);
+        const uint32_t next = nodes[node].neighbour_next;
+
+        nodes[split].neighbour_previous = node;
+        nodes[split].neighbour_next = next;
+        if (next != NONE)
+            nodes[next].neighbour_previous = split;
+        nodes[node].neighbour_next = split;
+
+        InsertFreeNode(split);
+    }
+
+    result.offset = nodes[node].offset;
+    result.node = node;
+    return result;
+}
+
+void OffsetAllocator::Free(const Allocation& allocation)
+{
+    if (!allocation.IsValid())
+        return;
+
+    const uint32_t node = allocation.node;
+    free_size += nodes[node].size;
+
+    uint32_t offset = nodes[node].offset;
+    uint32_t merged_size = nodes[node].size;
+
+    const uint32_t previous = nodes[node].neighbour_previous;
+    if (previous != NONE && !nodes[previous].used)
+    {
+        RemoveFreeNode(previous);
+        offset = nodes[previous].offset;
+        merged_size += nodes[previous].size;
+
+        nodes[node].neighbour_previous = nodes[previous].neighbour_previous;
+        if (nodes[node].neighbour_previous != NONE)
+            nodes[nodes[node].neighbour_previous].neighbour_next = node;
+        unused_nodes.push_back(previous);
+    }
+
+    const uint32_t next = nodes[node].neighbour_next;
+    if (next != NONE && !nodes[next].used)
+    {
+        RemoveFreeNode(next);
+        merged_size += nodes[next].size;
+
+        nodes[node].neighbour_next = nodes[next].neighbour_next;
+        if (nodes[node].neighbour_next != NONE)
+            nodes[nodes[node].neighbour_next].neighbour_previous = node;
+        unused_nodes.push_back(next);
+    }
+
+    nodes[node].offset = offset;
+    nodes[node].size = merged_size;
+    nodes[node].used = false;
+    InsertFreeNode(node);
+}
+
+uint32_t OffsetAllocator::GetAllocationSize(const Allocation& allocation) const
+{
+    return allocation.IsValid() ? nodes[allocation.node].size : 0;
+}
+
+uint32_t OffsetAllocator::GetLargestFreeSize() const
+{
+    if (!used_bins_top)
+        return 0;
+
+    const uint32_t top = GetHighestBit(used_bins_top);
+    const uint32_t bin = (top << SMALL_FLOAT_MANTISSA_BITS) | GetHighestBit(used_bins[top]);
+
+    uint32_t result = 0;
+    for (uint32_t node = bin_heads[bin]; node != NONE; node = nodes[node].bin_next)
+        result = nodes[node].size > result ? nodes[node].size : result;
+    return result;
+}
+
+uint32_t OffsetAllocator::CreateNode(uint32_t offset, uint32_t node_size)
+{
+    uint32_t node;
+    if (!unused_nodes.empty())
+    {
+        node = unused_nodes.back();
+        unused_nodes.pop_back();
+        nodes[node] = Node();
+    }
+    else
+    {
+        node = (uint32_t)nodes.size();
+        nodes.emplace_back();
+    }
+
+    nodes[node].offset = offset;
+    nodes[node].size = node_size;
+    return node;
+}
+
+void OffsetAllocator::InsertFreeNode(uint32_t node)
+{
+    const uint32_t bin = SizeToBinRoundDown(nodes[node].size);
+    const uint32_t top = bin >> SMALL_FLOAT_MANTISSA_BITS;
+
+    nodes[node].bin_previous = NONE;
+    nodes[node].bin_next = bin_heads[bin];
+    if (bin_heads[bin] != NONE)
+        nodes[bin_heads[bin]].bin_previous = node;
+    bin_heads[bin] = node;
+
+    used_bins_top |= 1u << top;
+    used_bins[top] |= 1u << (bin & SMALL_FLOAT_MANTISSA_MASK);
+}
+
+void OffsetAllocator::RemoveFreeNode(uint32_t node)
+{
+    const uint32_t previous = nodes[node].bin_previous;
+    const uint32_t next = nodes[node].bin_next;
+
+    if (next != NONE)
+        nodes[next].bin_previous = previous;
+
+    if (previous != NONE)
+    {
+        nodes[previous].bin_next = next;
+        return;
+    }
+
+    // It was the head of its bin
+    const uint32_t bin = SizeToBinRoundDown(nodes[node].size);
+    bin_heads[bin] = next;
+    if (next == NONE)
+    {
+        const uint32_t top = bin >> SMALL_FLOAT_MANTISSA_BITS;
+        used_bins[top] &= ~(1u << (bin & SMALL_FLOAT_MANTISSA_MASK));
+        if (!used_bins[top])
+            used_bins_top &= ~(1u << top);
+    }
+}
+
+GpuHeap::GpuHeap(const VertexAttribs* attribs, GLuint attrib_count, GLsizei vertex_stride_, uint32_t max_vertices,
+    uint32_t max_indices) : vertex_stride(vertex_stride_), vertex_allocator(max_vertices), index_allocator(max_indices)
+{
+    glCreateBuffers(1, &vbo);
+    glNamedBufferStorage(vbo, GLsizeiptr(max_vertices) * vertex_stride, nullptr, GL_DYNAMIC_STORAGE_BIT);
+
+    glCreateBuffers(1, &ibo);
+    glNamedBufferStorage(ibo, GLsizeiptr(max_indices) * sizeof(uint32_t), nullptr, GL_DYNAMIC_STORAGE_BIT);
+
+    // Every attribute reads the one interleaved buffer, their own buffers, strides and divisors are ignored
+    glCreateVertexArrays(1, &vao);
+    glVertexArrayVertexBuffer(vao, 0, vbo, 0, vertex_stride);
+    glVertexArrayElementBuffer(vao, ibo);
+
+    for (GLuint i = 0; i < attrib_count; ++i)
+    {
+        const VertexAttribs& attrib = attribs[i];
+        if (attrib.dims == 0)
+            continue;
+
+        if (attrib.integer)
+            glVertexArrayAttribIFormat(vao, i, attrib.dims, attrib.type, (GLuint)attrib.offset);
+        else
+            glVertexArrayAttribFormat(vao, i, attrib.dims, attrib.type, attrib.normalized, (GLuint)attrib.offset);
+
+        glVertexArrayAttribBinding(vao, i, 0);
+        glEnableVertexArrayAttrib(vao, i);
+    }
+}
+
+GpuHeap::~GpuHeap()
+{
+    glDeleteVertexArrays(1, &vao);
+    glDeleteBuffers(1, &vbo);
+    glDeleteBuffers(1, &ibo);
+}
+
+GpuHeap::MeshHandle GpuHeap::Allocate(const void* vertices, uint32_t vertex_count, const uint32_t* indices,
+    uint32_t index_count)
+{
+    OffsetAllocator::Allocation vertex_allocation = vertex_allocator.Allocate(vertex_count);
+    if (!vertex_allocation.IsValid())
+    {
+        std::cout << "GPU heap is out of space for " << vertex_count << " vertices" << std::endl;
+        return INVALID_HANDLE;
+    }
+
+    OffsetAllocator::Allocation index_allocation = index_allocator.Allocate(index_count);
+    if (!index_allocation.IsValid())
+    {
+        std::cout << "GPU heap is out of space for " << index_count << " indices" << std::endl;
+        vertex_allocator.Free(vertex_allocation);
+        return INVALID_HANDLE;
+    }
+
+    glNamedBufferSubData(vbo, GLintptr(vertex_allocation.offset) * vertex_stride,
+        GLsizeiptr(vertex_count) * vertex_stride, vertices);
+    glNamedBufferSubData(ibo, GLintptr(index_allocation.offset) * sizeof(uint32_t),
+        GLsizeiptr(index_count) * sizeof(uint32_t), indices);
+
+    MeshHandle handle;
+    if (!unused_handles.empty())
+    {
+        handle = unused_handles.back();
+        unused_handles.pop_back();
+    }
+    else
+    {
+        handle = (MeshHandle)entries.size();
+        entries.emplace_back();
+    }
+
+    Entry& entry = entries[handle];
+    entry.vertices = vertex_allocation;
+    entry.indices = index_allocation;
+    entry.vertex_count = vertex_count;
+    entry.index_count = index_count;
+    entry.live = true;
+    return handle;
+}
+
+void GpuHeap::Free(MeshHandle handle)
+{
+    if (handle >= entries.size() || !entries[handle].live)
+        return;
+
+    Entry& entry = entries[handle];
+    vertex_allocator.Free(entry.vertices);
+    index_allocator.Free(entry.indices);
+    entry = Entry();
+    unused_handles.push_back(handle);
+}
+
+GpuMesh GpuHeap::GetMesh(MeshHandle handle) const
+{
+    const Entry& entry = entries[handle];
+    return { (GLint)entry.vertices.offset, entry.indices.offset, entry.index_count };
+}
+
+unsigned int GpuHeap::Defragment(unsigned int max_moves)
+{
+    unsigned int move_count = 0;
+
+    // Resumes where the last call stopped, so every mesh gets its turn
+    for (size_t visited = 0; visited < entries.size() && move_count < max_moves; ++visited)
+    {
+        if (defragment_cursor >= entries.size())
+            defragment_cursor = 0;
+
+        Entry& entry = entries[defragment_cursor++];
+        if (!entry.live)
+            continue;
+
+        move_count += Move(vertex_allocator, entry.vertices, entry.vertex_count, vbo, vertex_stride);
+        move_count += Move(index_allocator, entry.indices, entry.index_count, ibo, sizeof(uint32_t));
+    }
+
+    return move_count;
+}
+
+bool GpuHeap::Move(OffsetAllocator& allocator, OffsetAllocator::Allocation& allocation, uint32_t count,
+    GLuint buffer, GLsizeiptr element_size)
+{
+    // Both ranges are allocated during the copy, so they can't overlap
+    OffsetAllocator::Allocation moved = allocator.Allocate(count);
+    if (!moved.IsValid())
+        return false;
+
+    if (moved.offset >= allocation.offset)
+    {
+        allocator.Free(moved);
+        return false;
+    }
+
+    // Note: GL orders the copy after the draws already submitted from the old range
+    glCopyNamedBufferSubData(buffer, buffer, GLintptr(allocation.offset) * element_size,
+        GLintptr(moved.offset) * element_size, GLsizeiptr(count) * element_size);
+
+    allocator.Free(allocation);
+    allocation = moved;
+    return true;
+}
+}   // namespace Ogle
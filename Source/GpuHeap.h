@@ -0,0 +1,142 @@
+#ifndef GPU_HEAP_H
+
+#include "Mesh.h"
+
+#include <glad/glad.h>
+#include <cstdint>
+#include <vector>
+
+namespace Ogle
+{
+// Two level segregated fit (TLSF) allocator of ranges in [0, size), in whatever unit the caller picks. It doesn't
+// touch the memory it manages, so it works for GPU buffers. Free blocks are binned by a small float of their size
+// (5 bit exponent, 3 bit mantissa) with a bitmask per level, so both allocating and freeing are O(1). Freed blocks
+// coalesce with their free neighbours right away.
+struct OffsetAllocator
+{
+    static constexpr uint32_t NO_SPACE = ~0u;
+
+    struct Allocation
+    {
+        uint32_t offset = NO_SPACE;
+        uint32_t node = NO_SPACE;
+
+        inline bool IsValid() const { return offset != NO_SPACE; }
+    };
+
+    explicit OffsetAllocator(uint32_t size_);
+
+    // Returns an invalid allocation if no free block is big enough
+    Allocation Allocate(uint32_t size);
+    void Free(const Allocation& allocation);
+
+    uint32_t GetAllocationSize(const Allocation& allocation) const;
+
+    inline uint32_t GetSize() const { return size; }
+    inline uint32_t GetFreeSize() const { return free_size; }
+    uint32_t GetLargestFreeSize() const;
+
+private:
+    static constexpr uint32_t BIN_COUNT = 256;
+    static constexpr uint32_t NONE = ~0u;
+
+    struct Node
+    {
+        uint32_t offset;
+        uint32_t size;
+        uint32_t bin_previous = NONE;
+        uint32_t bin_next = NONE;
+        uint32_t neighbour_previous = NONE;     // Adjacent blocks by offset
+        uint32_t neighbour_next = NONE;
+        bool used = false;
+    };
+
+    uint32_t CreateNode(uint32_t offset, uint32_t node_size);
+    void InsertFreeNode(uint32_t node);
+    void RemoveFreeNode(uint32_t node);
+
+    uint32_t size;
+    uint32_t free_size;
+
+    uint32_t used_bins_top = 0;
+    uint8_t used_bins[BIN_COUNT / 8] = {};
+    uint32_t bin_heads[BIN_COUNT];
+
+    std::vector<Node> nodes;
+    std::vector<uint32_t> unused_nodes;
+};
+
+// A mesh as a range of a GpuHeap, draw it with glDrawElementsBaseVertex (or as a multi-draw command) after binding
+// the heap. Indices are relative to base_vertex.
+struct GpuMesh
+{
+    GLint base_vertex;
+    GLuint first_index;
+    GLuint index_count;
+};
+
+// Shares one vertex buffer, one index buffer (32 bit) and one vertex array between many meshes of the same vertex
+// format, so drawing them needs no rebinding. Meshes are referred to by handles which stay valid while
+// Defragment() moves their data around.
+struct GpuHeap
+{
+    typedef uint32_t MeshHandle;
+    static constexpr MeshHandle INVALID_HANDLE = ~0u;
+
+    // Capacities are fixed, create another heap when one is full
+    GpuHeap(const VertexAttribs* attribs, GLuint attrib_count, GLsizei vertex_stride_, uint32_t max_vertices,
+        uint32_t max_indices);
+    ~GpuHeap();
+
+    GpuHeap(const GpuHeap&) = delete;
+    GpuHeap& operator=(const GpuHeap&) = delete;
+
+    // Returns INVALID_HANDLE if either buffer has no space left
+    MeshHandle Allocate(const void* vertices, uint32_t vertex_count, const uint32_t* indices, uint32_t index_count);
+    void Free(MeshHandle handle);
+
+    GpuMesh GetMesh(MeshHandle handle) const;
+
+    // Moves at most max_moves meshes to lower offsets with GPU side copies, so the free space merges towards the
+    // end of the buffers. Cheap enough to call every frame with a small budget. Returns the number of moves.
+    unsigned int Defragment(unsigned int max_moves);
+
+    inline void Bind() const { glBindVertexArray(vao); }
+    inline void Unbind() const { glBindVertexArray(0); }
+
+    inline GLuint GetVertexBuffer() const { return vbo; }
+    inline GLuint GetIndexBuffer() const { return ibo; }
+    inline GLuint GetVertexArray() const { return vao; }
+
+    inline const OffsetAllocator& GetVertexAllocator() const { return vertex_allocator; }
+    inline const OffsetAllocator& GetIndexAllocator() const { return index_allocator; }
+
+private:
+    struct Entry
+    {
+        OffsetAllocator::Allocation vertices;
+        OffsetAllocator::Allocation indices;
+        uint32_t vertex_count = 0;
+        uint32_t index_count = 0;
+        bool live = false;
+    };
+
+    bool Move(OffsetAllocator& allocator, OffsetAllocator::Allocation& allocation, uint32_t count, GLuint buffer,
+        GLsizeiptr element_size);
+
+    GLuint vbo = 0;
+    GLuint ibo = 0;
+    GLuint vao = 0;
+    GLsizei vertex_stride;
+
+    OffsetAllocator vertex_allocator;
+    OffsetAllocator index_allocator;
+
+    std::vector<Entry> entries;
+    std::vector<MeshHandle> unused_handles;
+    MeshHandle defragment_cursor = 0;
+};
+}   // namespace Ogle
+
+#define GPU_HEAP_H
+#endif
@@ -0,0 +1,90 @@
+#include "Input.h"
+
+namespace Ogle
+{
+void Input::BeginFrame()
+{
+    event_count = 0;
+
+    keys_pressed.reset();
+    keys_released.reset();
+
+    mouse_offset_x = 0.f;
+    mouse_offset_y = 0.f;
+    scroll_offset = 0.f;
+
+    resized = false;
+}
+
+void Input::Push(const InputEvent& event)
+{
+    switch (event.type)
+    {
+        case InputEventType::KeyPress:
+        {
+            if (IsValidKey(event.code))
+            {
+                keys_down[event.code] = true;
+                keys_pressed[event.code] = true;
+            }
+        } break;
+
+        case InputEventType::KeyRelease:
+        {
+            if (IsValidKey(event.code))
+            {
+                keys_down[event.code] = false;
+                keys_released[event.code] = true;
+            }
+        } break;
+
+        case InputEventType::MouseButtonPress:
+        {
+            if (IsValidButton(event.code))
+                buttons_down[event.code] = true;
+        } break;
+
+        case InputEventType::MouseButtonRelease:
+        {
+            if (IsValidButton(event.code))
+                buttons_down[event.code] = false;
+        } break;
+
+        case InputEventType::MouseMove:
+        {
+            mouse_offset_x += event.x;
+            mouse_offset_y += event.y;
+
+            if (event_count > 0 && events[event_count - 1].type == InputEventType::MouseMove)
+            {
+                events[event_count - 1].x += event.x;
+                events[event_count - 1].y += event.y;
+                return;
+            }
+        } break;
+
+        case InputEventType::MouseScroll:
+        {
+            scroll_offset += event.x;
+        } break;
+
+        case InputEventType::WindowResize:
+        {
+            resized = true;
+            resize_width = (unsigned int)event.x;
+            resize_height = (unsigned int)event.y;
+        } break;
+
+        default:
+            break;
+    }
+
+    if (event_count == MAX_EVENTS_PER_FRAME)
+    {
+        ++dropped_event_count;
+        return;
+    }
+
+    events[event_count++] = event;
+}
+}   // namespace Ogle
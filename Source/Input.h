@@ -0,0 +1,83 @@
+#ifndef INPUT_H
+
+#include <GLFW/glfw3.h>
+#include <bitset>
+#include <cstdint>
+
+namespace Ogle
+{
+enum class InputEventType : uint8_t
+{
+    KeyPress,
+    KeyRepeat,
+    KeyRelease,
+    MouseButtonPress,
+    MouseButtonRelease,
+    MouseMove,
+    MouseScroll,
+    WindowResize
+};
+
+struct InputEvent
+{
+    InputEventType type;
+    int code;       // Key or mouse button
+    float x;        // Cursor offset, scroll offset or new width
+    float y;        // Cursor offset or new height
+};
+
+// Input gathered by the GLFW callbacks during a frame. Events go into a fixed size array which is cleared at the
+// start of every frame, consecutive mouse moves are merged into a single event so high polling rate mice can't
+// flood it. Alongside, the current state of every key and mouse button is kept for polling.
+struct Input
+{
+    static constexpr unsigned int MAX_EVENTS_PER_FRAME = 256;
+
+    inline bool IsKeyDown(int key) const { return IsValidKey(key) && keys_down[key]; }
+    inline bool WasKeyPressed(int key) const { return IsValidKey(key) && keys_pressed[key]; }
+    inline bool WasKeyReleased(int key) const { return IsValidKey(key) && keys_released[key]; }
+    inline bool IsMouseButtonDown(int button) const { return IsValidButton(button) && buttons_down[button]; }
+    inline bool IsAnyKeyOrButtonDown() const { return keys_down.any() || buttons_down.any(); }
+
+    // Accumulated over the frame
+    inline float GetMouseOffsetX() const { return mouse_offset_x; }
+    inline float GetMouseOffsetY() const { return mouse_offset_y; }
+    inline float GetScrollOffset() const { return scroll_offset; }
+
+    // Latest framebuffer size of the frame, kept even if the event array overflowed
+    inline bool WasResized() const { return resized; }
+    inline unsigned int GetResizeWidth() const { return resize_width; }
+    inline unsigned int GetResizeHeight() const { return resize_height; }
+
+    inline const InputEvent* GetEvents() const { return events; }
+    inline unsigned int GetEventCount() const { return event_count; }
+    inline unsigned int GetDroppedEventCount() const { return dropped_event_count; }
+
+    void BeginFrame();
+    void Push(const InputEvent& event);
+
+private:
+    static inline bool IsValidKey(int key) { return key >= 0 && key <= GLFW_KEY_LAST; }
+    static inline bool IsValidButton(int button) { return button >= 0 && button <= GLFW_MOUSE_BUTTON_LAST; }
+
+    InputEvent events[MAX_EVENTS_PER_FRAME];
+    unsigned int event_count = 0;
+    unsigned int dropped_event_count = 0;
+
+    std::bitset<GLFW_KEY_LAST + 1> keys_down;
+    std::bitset<GLFW_KEY_LAST + 1> keys_pressed;
+    std::bitset<GLFW_KEY_LAST + 1> keys_released;
+    std::bitset<GLFW_MOUSE_BUTTON_LAST + 1> buttons_down;
+
+    float mouse_offset_x = 0.f;
+    float mouse_offset_y = 0.f;
+    float scroll_offset = 0.f;
+
+    bool resized = false;
+    unsigned int resize_width = 0;
+    unsigned int resize_height = 0;
+};
+}   // namespace Ogle
+
+#define INPUT_H
+#endif
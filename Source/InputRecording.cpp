@@ -0,0 +1,170 @@
+#include "InputRecording.h"
+
+#include <cstring>
+#include <iostream>
+
+namespace Ogle
+{
+static const char INPUT_RECORDING_MAGIC[4] = { 'O', 'G', 'I', 'R' };
+static const uint32_t INPUT_RECORDING_VERSION = 2;
+// Reads back differently on a host of the other byte order
+static const uint32_t INPUT_RECORDING_BYTE_ORDER = 0x01020304;
+static const uint32_t INPUT_RECORDING_BYTE_ORDER_SWAPPED = 0x04030201;
+static const size_t INPUT_RECORDING_EVENT_SIZE = 1 + 3 * 4;
+
+InputRecorder::~InputRecorder()
+{
+    Close();
+}
+
+bool InputRecorder::Open(const char* path)
+{
+    file = fopen(path, "wb");
+    if (!file)
+    {
+        std::cout << "Failed to open input recording for writing: " << path << std::endl;
+        return false;
+    }
+
+    fwrite(INPUT_RECORDING_MAGIC, 1, sizeof(INPUT_RECORDING_MAGIC), file);
+    fwrite(&INPUT_RECORDING_VERSION, sizeof(INPUT_RECORDING_VERSION), 1, file);
+    fwrite(&INPUT_RECORDING_BYTE_ORDER, sizeof(INPUT_RECORDING_BYTE_ORDER), 1, file);
+
+    return true;
+}
+
+void InputRecorder::Close()
+{
+    if (file)
+    {
+        fclose(file);
+        file = nullptr;
+    }
+}
+
+void InputRecorder::RecordFrame(float frame_time, float delta_time, const Input& input)
+{
+    if (!file)
+        return;
+
+    uint16_t event_count = (uint16_t)input.GetEventCount();
+
+    // Buffered by stdio, so this doesn't hit the disk every frame
+    fwrite(&frame_time, sizeof(frame_time), 1, file);
+    fwrite(&delta_time, sizeof(delta_time), 1, file);
+    fwrite(&event_count, sizeof(event_count), 1, file);
+
+    const InputEvent* events = input.GetEvents();
+    for (uint16_t i = 0; i < event_count; ++i)
+    {
+        unsigned char packed[INPUT_RECORDING_EVENT_SIZE];
+        packed[0] = (unsigned char)events[i].type;
+
+        int32_t code = events[i].code;
+        memcpy(packed + 1, &code, 4);
+        memcpy(packed + 5, &events[i].x, 4);
+        memcpy(packed + 9, &events[i].y, 4);
+
+        fwrite(packed, sizeof(packed), 1, file);
+    }
+}
+
+bool InputReplayer::Open(const char* path)
+{
+    FILE* file = fopen(path, "rb");
+    if (!file)
+    {
+        std::cout << "Failed to open input recording: " << path << std::endl;
+        return false;
+    }
+
+    char magic[4];
+    uint32_t version = 0;
+    uint32_t byte_order = 0;
+    if (fread(magic, 1, sizeof(magic), file) != sizeof(magic) || memcmp(magic, INPUT_RECORDING_MAGIC, 4) != 0 ||
+        fread(&version, sizeof(version), 1, file) != 1 || fread(&byte_order, sizeof(byte_order), 1, file) != 1)
+    {
+        std::cout << "Not an input recording: " << path << std::endl;
+        fclose(file);
+        return false;
+    }
+
+    if (version != INPUT_RECORDING_VERSION || byte_order != INPUT_RECORDING_BYTE_ORDER)
+    {
+        // The version reads back byte swapped as well then
+        if (byte_order == INPUT_RECORDING_BYTE_ORDER_SWAPPED)
+            std::cout << "Input recording was made on a host with another byte order: " << path << std::endl;
+        else
+            std::cout << "Not a supported input recording version: " << path << std::endl;
+
+        fclose(file);
+        return false;
+    }
+
+    frames.clear();
+    events.clear();
+    next_frame = 0;
+
+    while (true)
+    {
+        Frame frame;
+        uint16_t event_count;
+        if (fread(&frame.frame_time, sizeof(float), 1, file) != 1 || fread(&frame.delta_time, sizeof(float), 1, file) != 1
+            || fread(&event_count, sizeof(event_count), 1, file) != 1)
+        {
+            break;
+        }
+
+        frame.first_event = (uint32_t)events.size();
+        frame.event_count = event_count;
+
+        bool truncated = false;
+        for (uint16_t i = 0; i < event_count; ++i)
+        {
+            unsigned char packed[INPUT_RECORDING_EVENT_SIZE];
+            if (fread(packed, sizeof(packed), 1, file) != 1)
+            {
+                truncated = true;
+                break;
+            }
+
+            InputEvent event;
+            event.type = (InputEventType)packed[0];
+
+            int32_t code;
+            memcpy(&code, packed + 1, 4);
+            event.code = code;
+            memcpy(&event.x, packed + 5, 4);
+            memcpy(&event.y, packed + 9, 4);
+
+            events.push_back(event);
+        }
+
+        if (truncated)
+        {
+            events.resize(frame.first_event);
+            break;
+        }
+
+        frames.push_back(frame);
+    }
+
+    fclose(file);
+    return true;
+}
+
+bool InputReplayer::NextFrame(float& frame_time, float& delta_time, Input& input)
+{
+    if (next_frame == frames.size())
+        return false;
+
+    const Frame& frame = frames[next_frame++];
+    frame_time = frame.frame_time;
+    delta_time = frame.delta_time;
+
+    for (uint32_t i = 0; i < frame.event_count; ++i)
+        input.Push(events[frame.first_event + i]);
+
+    return true;
+}
+}   // namespace Ogle
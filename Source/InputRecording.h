@@ -0,0 +1,55 @@
+#ifndef INPUT_RECORDING_H
+
+#include "Input.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+namespace Ogle
+{
+// Binary format: a header ("OGIR", version, byte order marker), then per frame the frame time and delta time as
+// floats, the event count as uint16 followed by the events (uint8 type, int32 code, float x, float y), all in the
+// recording host's byte order. Replaying on a host with the other byte order is rejected via the marker.
+struct InputRecorder
+{
+    ~InputRecorder();
+
+    bool Open(const char* path);
+    void Close();
+
+    void RecordFrame(float frame_time, float delta_time, const Input& input);
+
+    inline bool IsOpen() const { return file != nullptr; }
+
+private:
+    FILE* file = nullptr;
+};
+
+struct InputReplayer
+{
+    // Loads the whole recording
+    bool Open(const char* path);
+
+    // Returns false once every frame was replayed
+    bool NextFrame(float& frame_time, float& delta_time, Input& input);
+
+    inline unsigned int GetFrameCount() const { return (unsigned int)frames.size(); }
+
+private:
+    struct Frame
+    {
+        float frame_time;
+        float delta_time;
+        uint32_t first_event;
+        uint32_t event_count;
+    };
+
+    std::vector<Frame> frames;
+    std::vector<InputEvent> events;
+    unsigned int next_frame = 0;
+};
+}   // namespace Ogle
+
+#define INPUT_RECORDING_H
+#endif
@@ -0,0 +1,24 @@
+#include "InstanceBuffer.h"
+
+namespace Ogle
+{
+// Several Map() calls per frame each waste up to this much
+static const size_t INSTANCE_BUFFER_ALIGNMENT = 16;
+
+InstanceBuffer::InstanceBuffer(GLsizei instance_size_, unsigned int max_instances_per_frame) :
+    stream(size_t(instance_size_) * max_instances_per_frame + INSTANCE_BUFFER_ALIGNMENT), instance_size(instance_size_)
+{
+}
+
+void* InstanceBuffer::Map(unsigned int instance_count_)
+{
+    current = stream.Allocate(size_t(instance_size) * instance_count_, INSTANCE_BUFFER_ALIGNMENT);
+    instance_count = current.cpu_pointer ? instance_count_ : 0;
+    return current.cpu_pointer;
+}
+
+void InstanceBuffer::Bind(VertexArray& vao, GLuint binding) const
+{
+    vao.SetInstanceBuffer(binding, stream.GetId(), current.gpu_offset, instance_size);
+}
+}   // namespace Ogle
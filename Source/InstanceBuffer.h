@@ -0,0 +1,42 @@
+#ifndef INSTANCE_BUFFER_H
+
+#include "Mesh.h"
+#include "StreamBuffer.h"
+
+namespace Ogle
+{
+// Per instance data rewritten every frame (transforms, colours), streamed through a persistently mapped
+// StreamBuffer. Attach it to a VertexArray's instance stream (VertexArray::AddInstanceStream) after filling it:
+//
+//     InstanceData* instances = (InstanceData*)instance_buffer.Map(count);
+//     ...fill instances...
+//     instance_buffer.Bind(vao, INSTANCE_BINDING);
+//     DrawInstanced(vao, ibo, count);
+struct InstanceBuffer
+{
+    InstanceBuffer(GLsizei instance_size_, unsigned int max_instances_per_frame);
+
+    inline void BeginFrame() { stream.BeginFrame(); }
+    inline void EndFrame() { stream.EndFrame(); }
+
+    // Room for instance_count instances, valid until the next Map() in this frame. Returns nullptr if the frame's
+    // space ran out.
+    void* Map(unsigned int instance_count);
+
+    // Points binding of vao at the last Map()'s instances
+    void Bind(VertexArray& vao, GLuint binding) const;
+
+    inline GLsizei GetInstanceSize() const { return instance_size; }
+    inline unsigned int GetInstanceCount() const { return instance_count; }
+
+private:
+    StreamBuffer stream;
+    GLsizei instance_size;
+
+    StreamAllocation current;
+    unsigned int instance_count = 0;
+};
+}   // namespace Ogle
+
+#define INSTANCE_BUFFER_H
+#endif
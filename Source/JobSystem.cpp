@@ -0,0 +1,221 @@
+#include "JobSystem.h"
+
+#include <memory>
+
+namespace Ogle
+{
+static thread_local unsigned int current_thread_index = 0;
+
+JobSystem::~JobSystem()
+{
+    Stop();
+}
+
+void JobSystem::Start(unsigned int worker_count)
+{
+    if (worker_count == 0)
+    {
+        unsigned int hardware_thread_count = std::thread::hardware_concurrency();
+        worker_count = hardware_thread_count > 1 ? hardware_thread_count - 1 : 1;
+    }
+
+    stopping = false;
+
+    queues.resize(worker_count + 1);
+    for (WorkQueue*& queue : queues)
+        queue = new WorkQueue;
+
+    workers.reserve(worker_count);
+    for (unsigned int i = 1; i <= worker_count; ++i)
+        workers.emplace_back(&JobSystem::WorkerMain, this, i);
+}
+
+void JobSystem::Stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex);
+        stopping = true;
+    }
+    sleep_condition.notify_all();
+
+    for (std::thread& worker : workers)
+        worker.join();
+    workers.clear();
+
+    for (WorkQueue* queue : queues)
+        delete queue;
+    queues.clear();
+}
+
+void JobSystem::Submit(JobGroup& group, std::function<void()> function)
+{
+    group.pending.fetch_add(1, std::memory_order_relaxed);
+
+    Job job;
+    job.function = std::move(function);
+    job.group = &group;
+    Push(std::move(job));
+}
+
+void JobSystem::SubmitAfter(JobGroup& dependency, JobGroup& group, std::function<void()> function)
+{
+    group.pending.fetch_add(1, std::memory_order_relaxed);
+
+    Job job;
+    job.function = std::move(function);
+    job.group = &group;
+
+    {
+        // The thread finishing the last job of dependency takes the continuations under the same lock, so either
+        // it sees this one or this sees the dependency being done
+        std::lock_guard<std::mutex> lock(dependency.continuation_mutex);
+        if (!dependency.IsDone())
+        {
+            dependency.continuations.push_back(std::move(job));
+            return;
+        }
+    }
+
+    Push(std::move(job));
+}
+
+void JobSystem::ParallelFor(JobGroup& group, unsigned int count, unsigned int batch_size,
+    std::function<void(unsigned int begin, unsigned int end)> function)
+{
+    if (count == 0)
+        return;
+
+    if (batch_size == 0)
+        batch_size = 1;
+
+    // One shared copy instead of one per batch
+    auto shared_function = std::make_shared<std::function<void(unsigned int, unsigned int)>>(std::move(function));
+
+    for (unsigned int begin = 0; begin < count; begin += batch_size)
+    {
+        unsigned int end = count - begin > batch_size ? begin + batch_size : count;
+        Submit(group, [shared_function, begin, end]() { (*shared_function)(begin, end); });
+    }
+}
+
+void JobSystem::Wait(JobGroup& group)
+{
+    while (!group.IsDone())
+    {
+        Job job;
+        if (TryPop(job))
+            Execute(job);
+        else
+            std::this_thread::yield();
+    }
+
+    // The last job releases this lock after marking the group done, so the group can be safely destroyed after
+    std::lock_guard<std::mutex> lock(group.continuation_mutex);
+}
+
+unsigned int JobSystem::GetThreadIndex()
+{
+    return current_thread_index;
+}
+
+void JobSystem::Push(Job&& job)
+{
+    WorkQueue* queue = queues[current_thread_index < queues.size() ? current_thread_index : 0];
+    {
+        std::lock_guard<std::mutex> lock(queue->mutex);
+        queue->jobs.push_back(std::move(job));
+        queued_job_count.fetch_add(1, std::memory_order_release);
+    }
+
+    // Taking the lock makes sure a worker can't miss the notification between checking the count and sleeping
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex);
+    }
+    sleep_condition.notify_one();
+}
+
+bool JobSystem::TryPop(Job& job)
+{
+    if (queued_job_count.load(std::memory_order_acquire) == 0)
+        return false;
+
+    const unsigned int queue_count = (unsigned int)queues.size();
+    const unsigned int own_index = current_thread_index < queue_count ? current_thread_index : 0;
+
+    {
+        WorkQueue* queue = queues[own_index];
+        std::lock_guard<std::mutex> lock(queue->mutex);
+        if (!queue->jobs.empty())
+        {
+            job = std::move(queue->jobs.back());
+            queue->jobs.pop_back();
+            queued_job_count.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    for (unsigned int i = 1; i < queue_count; ++i)
+    {
+        WorkQueue* victim = queues[(own_index + i) % queue_count];
+        std::lock_guard<std::mutex> lock(victim->mutex);
+        if (!victim->jobs.empty())
+        {
+            job = std::move(victim->jobs.front());
+            victim->jobs.pop_front();
+            queued_job_count.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void JobSystem::Execute(Job& job)
+{
+    job.function();
+
+    JobGroup* group = job.group;
+
+    // Unless this might be the last job of the group, a plain decrement is enough
+    unsigned int pending = group->pending.load(std::memory_order_relaxed);
+    while (pending > 1)
+    {
+        if (group->pending.compare_exchange_weak(pending, pending - 1, std::memory_order_acq_rel))
+            return;
+    }
+
+    std::vector<Job> continuations;
+    {
+        std::lock_guard<std::mutex> lock(group->continuation_mutex);
+        if (group->pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            continuations.swap(group->continuations);
+    }
+
+    for (Job& continuation : continuations)
+        Push(std::move(continuation));
+}
+
+void JobSystem::WorkerMain(unsigned int thread_index)
+{
+    current_thread_index = thread_index;
+
+    while (true)
+    {
+        Job job;
+        if (TryPop(job))
+        {
+            Execute(job);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleep_mutex);
+        sleep_condition.wait(lock, [this]()
+        {
+            return stopping || queued_job_count.load(std::memory_order_acquire) > 0;
+        });
+
+        if (stopping)
+            return;
+    }
+}
+}   // namespace Ogle
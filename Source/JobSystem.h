@@ -0,0 +1,88 @@
+#ifndef JOB_SYSTEM_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Ogle
+{
+struct JobGroup;
+
+struct Job
+{
+    std::function<void()> function;
+    JobGroup* group = nullptr;
+};
+
+// Counts the unfinished jobs submitted with it. A group must outlive its jobs, i.e. wait on it before it goes out
+// of scope.
+struct JobGroup
+{
+    inline bool IsDone() const { return pending.load(std::memory_order_acquire) == 0; }
+
+private:
+    friend struct JobSystem;
+
+    std::atomic<unsigned int> pending{ 0 };
+
+    std::mutex continuation_mutex;
+    std::vector<Job> continuations;
+};
+
+// Work-stealing thread pool. Every thread has its own queue: it pushes and pops at the back (LIFO, cache friendly)
+// while idle threads steal from the front of the others (FIFO, the oldest and usually biggest pieces of work).
+// The thread which called Start() (the main thread) owns queue 0 and executes jobs while waiting in Wait().
+struct JobSystem
+{
+    ~JobSystem();
+
+    // worker_count == 0 means one worker per hardware thread, besides the calling thread
+    void Start(unsigned int worker_count = 0);
+    void Stop();
+
+    void Submit(JobGroup& group, std::function<void()> function);
+
+    // function is only queued once every job in dependency has finished, it still counts towards group right away
+    void SubmitAfter(JobGroup& dependency, JobGroup& group, std::function<void()> function);
+
+    // Calls function(begin, end) for consecutive ranges of at most batch_size covering [0, count)
+    void ParallelFor(JobGroup& group, unsigned int count, unsigned int batch_size,
+        std::function<void(unsigned int begin, unsigned int end)> function);
+
+    // Executes queued jobs on the calling thread until every job in group has finished
+    void Wait(JobGroup& group);
+
+    // Workers plus the main thread
+    inline unsigned int GetThreadCount() const { return (unsigned int)queues.size(); }
+
+    // 0 for the main thread (or any thread not owned by a JobSystem), 1..worker count for the workers
+    static unsigned int GetThreadIndex();
+
+private:
+    struct WorkQueue
+    {
+        std::mutex mutex;
+        std::deque<Job> jobs;
+    };
+
+    void Push(Job&& job);
+    bool TryPop(Job& job);
+    void Execute(Job& job);
+    void WorkerMain(unsigned int thread_index);
+
+    std::vector<WorkQueue*> queues;
+    std::vector<std::thread> workers;
+
+    std::atomic<unsigned int> queued_job_count{ 0 };
+    std::mutex sleep_mutex;
+    std::condition_variable sleep_condition;
+    bool stopping = false;
+};
+}   // namespace Ogle
+
+#define JOB_SYSTEM_H
+#endif
@@ -0,0 +1,108 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+// Note: Not Win32.h, which defines NOKERNEL
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <iostream>
+
+namespace Ogle
+{
+#ifdef _WIN32
+MappedFile* MappedFile::Open(const char* path)
+{
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        std::cout << "Failed to open file: " << path << std::endl;
+        return nullptr;
+    }
+
+    MappedFile* result = new MappedFile;
+    result->file_handle = file;
+
+    LARGE_INTEGER size;
+    GetFileSizeEx(file, &size);
+    result->size = (size_t)size.QuadPart;
+
+    // Empty files can't be mapped
+    if (result->size == 0)
+        return result;
+
+    result->mapping_handle = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (result->mapping_handle)
+        result->data = (const char*)MapViewOfFile(result->mapping_handle, FILE_MAP_READ, 0, 0, 0);
+
+    if (!result->data)
+    {
+        std::cout << "Failed to map file: " << path << std::endl;
+        delete result;
+        return nullptr;
+    }
+
+    return result;
+}
+
+MappedFile::~MappedFile()
+{
+    if (data)
+        UnmapViewOfFile(data);
+    if (mapping_handle)
+        CloseHandle(mapping_handle);
+    if (file_handle)
+        CloseHandle(file_handle);
+}
+#else
+MappedFile* MappedFile::Open(const char* path)
+{
+    int file_descriptor = open(path, O_RDONLY);
+    if (file_descriptor == -1)
+    {
+        std::cout << "Failed to open file: " << path << std::endl;
+        return nullptr;
+    }
+
+    MappedFile* result = new MappedFile;
+    result->file_descriptor = file_descriptor;
+
+    struct stat status;
+    fstat(file_descriptor, &status);
+    result->size = (size_t)status.st_size;
+
+    // Empty files can't be mapped
+    if (result->size == 0)
+        return result;
+
+    void* mapping = mmap(nullptr, result->size, PROT_READ, MAP_PRIVATE, file_descriptor, 0);
+    if (mapping == MAP_FAILED)
+    {
+        std::cout << "Failed to map file: " << path << std::endl;
+        delete result;
+        return nullptr;
+    }
+
+    // Chunks get parsed in parallel, so ask for readahead of the whole file rather than sequential access
+    madvise(mapping, result->size, MADV_WILLNEED);
+    result->data = (const char*)mapping;
+
+    return result;
+}
+
+MappedFile::~MappedFile()
+{
+    if (data)
+        munmap((void*)data, size);
+    if (file_descriptor != -1)
+        close(file_descriptor);
+}
+#endif
+}   // namespace Ogle
@@ -0,0 +1,32 @@
+#ifndef MAPPED_FILE_H
+
+#include <cstddef>
+
+namespace Ogle
+{
+// Read-only memory mapping of a whole file, the OS pages it in on demand so there is no upfront copy
+struct MappedFile
+{
+    static MappedFile* Open(const char* path);
+    ~MappedFile();
+
+    inline const char* GetData() const { return data; }
+    inline size_t GetSize() const { return size; }
+
+private:
+    MappedFile() = default;
+
+    const char* data = nullptr;
+    size_t size = 0;
+
+#ifdef _WIN32
+    void* file_handle = nullptr;
+    void* mapping_handle = nullptr;
+#else
+    int file_descriptor = -1;
+#endif
+};
+}   // namespace Ogle
+
+#define MAPPED_FILE_H
+#endif
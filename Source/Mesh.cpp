@@ -1,8 +1,11 @@
 #include "Mesh.h"
 
+#include <cmath>
+#include <cstring>
+
 namespace Ogle
 {
-VertexBuffer::VertexBuffer(void* vertices, size_t vertices_size)
+VertexBuffer::VertexBuffer(const void* vertices, size_t vertices_size)
 {
     glGenBuffers(1, &id);
     Bind();
@@ -15,36 +18,197 @@ VertexBuffer::~VertexBuffer()
     glDeleteBuffers(1, &id);
 }
 
+GLenum GetCompactIndexType(unsigned int max_index, bool allow_8_bit)
+{
+    if (allow_8_bit && max_index <= 0xff)
+        return GL_UNSIGNED_BYTE;
+    if (max_index <= 0xffff)
+        return GL_UNSIGNED_SHORT;
+    return GL_UNSIGNED_INT;
+}
+
+size_t GetIndexTypeSize(GLenum index_type)
+{
+    switch (index_type)
+    {
+        case GL_UNSIGNED_BYTE: return 1;
+        case GL_UNSIGNED_SHORT: return 2;
+        default: return 4;
+    }
+}
+
+void ConvertIndices(const unsigned int* indices, unsigned int index_count, GLenum index_type, void* destination)
+{
+    switch (index_type)
+    {
+        case GL_UNSIGNED_BYTE:
+        {
+            uint8_t* result = (uint8_t*)destination;
+            for (unsigned int i = 0; i < index_count; ++i)
+                result[i] = (uint8_t)indices[i];
+        } break;
+
+        case GL_UNSIGNED_SHORT:
+        {
+            uint16_t* result = (uint16_t*)destination;
+            for (unsigned int i = 0; i < index_count; ++i)
+                result[i] = (uint16_t)indices[i];
+        } break;
+
+        default:
+            memcpy(destination, indices, index_count * sizeof(unsigned int));
+    }
+}
+
+unsigned int GetMaxIndex(const unsigned int* indices, unsigned int index_count)
+{
+    unsigned int max_index = 0;
+    for (unsigned int i = 0; i < index_count; ++i)
+        max_index = indices[i] > max_index ? indices[i] : max_index;
+    return max_index;
+}
+
 IndexBuffer::IndexBuffer(void* indices, size_t indices_size)
+    : IndexBuffer(indices, (unsigned int)(indices_size / sizeof(unsigned int)), GL_UNSIGNED_INT)
+{}
+
+IndexBuffer::IndexBuffer(const void* indices, unsigned int index_count_, GLenum index_type_)
+    : index_type(index_type_), index_count(index_count_)
 {
     glGenBuffers(1, &id);
     Bind();
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices_size, indices, GL_STATIC_DRAW);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, index_count * GetIndexTypeSize(index_type), indices, GL_STATIC_DRAW);
     Unbind();
 }
 
+IndexBuffer* IndexBuffer::CreateCompact(const unsigned int* indices, unsigned int index_count, bool allow_8_bit)
+{
+    GLenum index_type = GetCompactIndexType(GetMaxIndex(indices, index_count), allow_8_bit);
+    if (index_type == GL_UNSIGNED_INT)
+        return new IndexBuffer(indices, index_count, index_type);
+
+    std::vector<unsigned char> compact(index_count * GetIndexTypeSize(index_type));
+    ConvertIndices(indices, index_count, index_type, compact.data());
+    return new IndexBuffer(compact.data(), index_count, index_type);
+}
+
 IndexBuffer::~IndexBuffer()
 {
     glDeleteBuffers(1, &id);
 }
 
-VertexArray::VertexArray(VertexBuffer* vbo, IndexBuffer* ibo, VertexAttribs* attribs, GLuint attrib_count, GLsizei stride)
+GLsizei VertexAttribs::GetSize() const
+{
+    switch (type)
+    {
+        case GL_BYTE:
+        case GL_UNSIGNED_BYTE:
+            return dims;
+
+        case GL_SHORT:
+        case GL_UNSIGNED_SHORT:
+        case GL_HALF_FLOAT:
+            return 2 * dims;
+
+        // Packed, all 4 components share 32 bits
+        case GL_INT_2_10_10_10_REV:
+        case GL_UNSIGNED_INT_2_10_10_10_REV:
+        case GL_UNSIGNED_INT_10F_11F_11F_REV:
+            return 4;
+
+        case GL_DOUBLE:
+            return 8 * dims;
+
+        default:
+            return 4 * dims;
+    }
+}
+
+uint16_t PackHalf(float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+
+    uint32_t sign = (bits >> 16) & 0x8000;
+    int32_t exponent = int32_t((bits >> 23) & 0xff) - 127 + 15;
+    uint32_t mantissa = bits & 0x7fffff;
+
+    // NaN stays NaN, everything too large becomes infinity
+    if (((bits >> 23) & 0xff) == 0xff)
+        return uint16_t(sign | 0x7c00 | (mantissa ? 0x200 : 0));
+    if (exponent >= 31)
+        return uint16_t(sign | 0x7c00);
+
+    // Denormals, or zero when too small
+    if (exponent <= 0)
+    {
+        if (exponent < -10)
+            return uint16_t(sign);
+
+        mantissa |= 0x800000;
+        uint32_t shift = uint32_t(14 - exponent);
+        uint32_t half_mantissa = mantissa >> shift;
+        uint32_t remainder = mantissa & ((1u << shift) - 1);
+        uint32_t halfway = 1u << (shift - 1);
+        if (remainder > halfway || (remainder == halfway && (half_mantissa & 1)))
+            ++half_mantissa;
+        return uint16_t(sign | half_mantissa);
+    }
+
+    // Round to nearest even, a carry out of the mantissa correctly bumps the exponent
+    uint32_t half = sign | (uint32_t(exponent) << 10) | (mantissa >> 13);
+    uint32_t remainder = mantissa & 0x1fff;
+    if (remainder > 0x1000 || (remainder == 0x1000 && (half & 1)))
+        ++half;
+    return uint16_t(half);
+}
+
+static inline uint32_t PackSnorm(float value, uint32_t bits)
+{
+    const float max = float((1 << (bits - 1)) - 1);
+    int32_t quantized = (int32_t)std::round((value < -1.f ? -1.f : (value > 1.f ? 1.f : value)) * max);
+    return uint32_t(quantized) & ((1u << bits) - 1);
+}
+
+uint32_t PackSnorm10_10_10_2(float x, float y, float z, float w)
+{
+    return PackSnorm(x, 10) | (PackSnorm(y, 10) << 10) | (PackSnorm(z, 10) << 20) | (PackSnorm(w, 2) << 30);
+}
+
+VertexArray::VertexArray(const VertexBuffer* vbo, const IndexBuffer* ibo, const VertexAttribs* attribs,
+    GLuint attrib_count, GLsizei stride)
 {
     glGenVertexArrays(1, &id);
 
     Bind();
-    vbo->Bind();
     if (ibo) ibo->Bind();
 
     for (GLuint i = 0; i < attrib_count; ++i)
     {
-        glVertexAttribPointer(i, attribs[i].dims, GL_FLOAT, GL_FALSE, stride, (const GLvoid*)attribs[i].offset);
+        const VertexAttribs& attrib = attribs[i];
+        if (attrib.dims == 0)
+            continue;
+
+        // The attribute captures the buffer bound to GL_ARRAY_BUFFER
+        const VertexBuffer* buffer = attrib.buffer ? attrib.buffer : vbo;
+        buffer->Bind();
+
+        const GLsizei attrib_stride = attrib.stride ? attrib.stride : stride;
+        if (attrib.integer)
+            glVertexAttribIPointer(i, attrib.dims, attrib.type, attrib_stride, (const GLvoid*)attrib.offset);
+        else
+            glVertexAttribPointer(i, attrib.dims, attrib.type, attrib.normalized, attrib_stride,
+                (const GLvoid*)attrib.offset);
+
         glEnableVertexAttribArray(i);
+        if (attrib.divisor != 0)
+            glVertexAttribDivisor(i, attrib.divisor);
     }
 
-    vbo->Unbind();
-    if (ibo) ibo->Unbind();
+    // Note: The element array binding is part of the VAO, so it must be unbound first
     Unbind();
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    if (ibo) ibo->Unbind();
 }
 
 VertexArray::~VertexArray()
@@ -52,7 +216,51 @@ VertexArray::~VertexArray()
     glDeleteVertexArrays(1, &id);
 }
 
-Mesh::Mesh(const float* vertices, unsigned int vertex_count, const unsigned int* indices, unsigned int index_count)
+void VertexArray::AddInstanceStream(GLuint binding, const InstanceAttrib* attribs, GLuint attrib_count,
+    GLuint divisor)
+{
+    for (GLuint i = 0; i < attrib_count; ++i)
+    {
+        const InstanceAttrib& attrib = attribs[i];
+
+        VertexAttribs column = {};
+        column.dims = 4;
+        column.type = attrib.type;
+        const GLuint column_size = (GLuint)column.GetSize();
+
+        for (GLint first = 0, location = attrib.location; first < attrib.dims; first += 4, ++location)
+        {
+            const GLint dims = attrib.dims - first < 4 ? attrib.dims - first : 4;
+            const GLuint offset = attrib.offset + (first / 4) * column_size;
+
+            if (attrib.integer)
+                glVertexArrayAttribIFormat(id, location, dims, attrib.type, offset);
+            else
+                glVertexArrayAttribFormat(id, location, dims, attrib.type, attrib.normalized, offset);
+
+            glVertexArrayAttribBinding(id, location, binding);
+            glEnableVertexArrayAttrib(id, location);
+        }
+    }
+
+    glVertexArrayBindingDivisor(id, binding, divisor);
+}
+
+void VertexArray::SetInstanceBuffer(GLuint binding, GLuint buffer, GLintptr offset, GLsizei stride)
+{
+    glVertexArrayVertexBuffer(id, binding, buffer, offset, stride);
+}
+
+void DrawInstanced(const VertexArray& vao, const IndexBuffer& ibo, unsigned int instance_count,
+    unsigned int base_instance, GLenum mode)
+{
+    vao.Bind();
+    glDrawElementsInstancedBaseInstance(mode, ibo.GetIndexCount(), ibo.GetIndexType(), nullptr, instance_count,
+        base_instance);
+}
+
+Mesh::Mesh(const float* vertices, unsigned int vertex_count, const unsigned int* indices, unsigned int index_count_)
+    : index_type(GetCompactIndexType(GetMaxIndex(indices, index_count_))), index_count(index_count_)
 {
     glGenVertexArrays(1, &vao);
     BindVAO();
@@ -63,7 +271,9 @@ Mesh::Mesh(const float* vertices, unsigned int vertex_count, const unsigned int*
 
     glGenBuffers(1, &ibo);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, index_count * sizeof(unsigned int), indices, GL_STATIC_DRAW);
+    std::vector<unsigned char> compact_indices(index_count * GetIndexTypeSize(index_type));
+    ConvertIndices(indices, index_count, index_type, compact_indices.data());
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, compact_indices.size(), compact_indices.data(), GL_STATIC_DRAW);
 
     glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
     glEnableVertexAttribArray(0);
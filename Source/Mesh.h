@@ -1,13 +1,15 @@
 #ifndef MESH_H
 
 #include <glad/glad.h>
+#include <cstddef>
 #include <cstdint>
+#include <vector>
 
 namespace Ogle
 {
 struct VertexBuffer
 {
-    VertexBuffer(void* vertices, size_t vertices_size);
+    VertexBuffer(const void* vertices, size_t vertices_size);
     ~VertexBuffer();
 
     inline void Bind() const { glBindBuffer(GL_ARRAY_BUFFER, id); }
@@ -17,49 +19,123 @@ private:
     GLuint id;
 };
 
+// Narrowest of GL_UNSIGNED_BYTE (only if allowed, it's slow on some hardware), GL_UNSIGNED_SHORT and
+// GL_UNSIGNED_INT that can hold max_index
+GLenum GetCompactIndexType(unsigned int max_index, bool allow_8_bit = false);
+size_t GetIndexTypeSize(GLenum index_type);
+unsigned int GetMaxIndex(const unsigned int* indices, unsigned int index_count);
+
+// Converts 32 bit indices to index_type, destination must hold index_count * GetIndexTypeSize(index_type) bytes
+void ConvertIndices(const unsigned int* indices, unsigned int index_count, GLenum index_type, void* destination);
+
 struct IndexBuffer
 {
+    // 32 bit indices
     IndexBuffer(void* indices, size_t indices_size);
+    IndexBuffer(const void* indices, unsigned int index_count, GLenum index_type_);
     ~IndexBuffer();
 
+    // Stores the indices with the narrowest type that fits the largest of them
+    static IndexBuffer* CreateCompact(const unsigned int* indices, unsigned int index_count, bool allow_8_bit = false);
+
     inline void Bind() const { glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, id); }
     inline void Unbind() const { glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0); }
 
+    // Pass these to glDrawElements
+    inline GLenum GetIndexType() const { return index_type; }
+    inline unsigned int GetIndexCount() const { return index_count; }
+
 private:
     GLuint id;
+    GLenum index_type;
+    unsigned int index_count;
 };
 
+// Describes one vertex attribute, in the order of the shader locations. Besides GL_FLOAT, the type can be e.g.
+// GL_HALF_FLOAT, GL_(UNSIGNED_)BYTE/SHORT or GL_(UNSIGNED_)INT_2_10_10_10_REV (dims must be 4 then), with
+// normalized mapping integer types to [0, 1] or [-1, 1]. Integer attributes reach the shader as ints (ivec/uvec)
+// instead of being converted to floats. A non-zero divisor advances the attribute per that many instances
+// instead of per vertex. Attributes can come from their own buffer with their own stride, otherwise the
+// VertexArray's are used. Attributes with dims == 0 leave their location disabled.
 struct VertexAttribs
 {
     GLint dims;
     uint64_t offset;
+    GLenum type = GL_FLOAT;
+    GLboolean normalized = GL_FALSE;
+    bool integer = false;
+    GLuint divisor = 0;
+    GLsizei stride = 0;
+    const VertexBuffer* buffer = nullptr;
+
+    // In bytes
+    GLsizei GetSize() const;
+};
+
+// Quantization helpers for filling vertex buffers with the packed formats above
+uint16_t PackHalf(float value);
+// To GL_INT_2_10_10_10_REV, normalized, components clamped to [-1, 1]
+uint32_t PackSnorm10_10_10_2(float x, float y, float z, float w = 0.f);
+
+// A per instance attribute of an instance stream. dims > 4 spills into the following locations, 4 components
+// each, e.g. a mat4 (dims == 16) takes location to location + 3, one column each.
+struct InstanceAttrib
+{
+    GLuint location;
+    GLint dims;
+    GLuint offset;
+    GLenum type = GL_FLOAT;
+    GLboolean normalized = GL_FALSE;
+    bool integer = false;
 };
 
 struct VertexArray
 {
-    VertexArray(VertexBuffer* vbo, IndexBuffer* ibo, VertexAttribs* attribs, GLuint attrib_count, GLsizei stride);
+    // vbo may be null if every attribute has its own buffer
+    VertexArray(const VertexBuffer* vbo, const IndexBuffer* ibo, const VertexAttribs* attribs, GLuint attrib_count,
+        GLsizei stride);
     ~VertexArray();
 
     inline void Bind() const { glBindVertexArray(id); }
     inline void Unbind() const { glBindVertexArray(0); }
 
+    // Adds attributes advancing once every divisor instances, all read from the buffer later attached to binding
+    // with SetInstanceBuffer(). Note: The constructor's attribute i uses binding i, so pick a binding no per vertex
+    // attribute uses, e.g. the stream's first location.
+    void AddInstanceStream(GLuint binding, const InstanceAttrib* attribs, GLuint attrib_count, GLuint divisor = 1);
+
+    // Cheap enough to call every frame, e.g. to point the stream at this frame's part of a StreamBuffer
+    void SetInstanceBuffer(GLuint binding, GLuint buffer, GLintptr offset, GLsizei stride);
+
+    inline GLuint GetId() const { return id; }
+
 private:
     GLuint id;
 };
 
+// Draws instance_count instances of the whole index buffer, base_instance offsets the instance attributes
+void DrawInstanced(const VertexArray& vao, const IndexBuffer& ibo, unsigned int instance_count,
+    unsigned int base_instance = 0, GLenum mode = GL_TRIANGLES);
+
 // Todo: Make Mesh use the aforementioned classes, or do we need Mesh at all?
 struct Mesh
 {
-    Mesh(const float* vertices, unsigned int vertex_count, const unsigned int* indices, unsigned int index_count);
+    // The indices get stored with the narrowest type that fits them, see GetIndexType
+    Mesh(const float* vertices, unsigned int vertex_count, const unsigned int* indices, unsigned int index_count_);
     ~Mesh();
 
     inline void BindVAO() const { glBindVertexArray(vao); }
     inline void UnbindVAO() const { glBindVertexArray(0); }
 
+    inline GLenum GetIndexType() const { return index_type; }
+    inline unsigned int GetIndexCount() const { return index_count; }
+
 private:
     GLuint vao;
     GLuint vbo;
     GLuint ibo;
+    GLenum index_type;
+    unsigned int index_count;
 };
 }   // namespace Ogle
 
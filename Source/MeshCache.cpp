@@ -0,0 +1,225 @@
+#include "MeshCache.h"
+
+#include "MappedFile.h"
+
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+namespace Ogle
+{
+static const char MESH_CACHE_MAGIC[4] = { 'O', 'G', 'M', 'C' };
+// Reads back differently on a host of the other byte order
+static const uint32_t MESH_CACHE_BYTE_ORDER = 0x01020304;
+
+struct MeshCacheHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t byte_order;
+    uint32_t padding;
+
+    uint32_t vertex_count;
+    uint32_t vertex_stride;
+    uint32_t index_count;
+    uint32_t index_type;
+    uint32_t attrib_count;
+    uint32_t lod_count;
+
+    float bounds_min[3];
+    float bounds_max[3];
+
+    uint64_t attribs_offset;
+    uint64_t lods_offset;
+    uint64_t vertices_offset;
+    uint64_t indices_offset;
+};
+
+struct MeshCacheAttrib
+{
+    uint32_t dims;
+    uint32_t offset;
+    uint32_t type;
+    uint8_t normalized;
+    uint8_t integer;
+    uint16_t padding;
+};
+
+static inline uint64_t AlignOffset(uint64_t offset)
+{
+    return (offset + 15) & ~uint64_t(15);
+}
+
+static void WritePadded(FILE* file, const void* data, size_t size, uint64_t& offset)
+{
+    static const unsigned char ZEROS[16] = {};
+
+    fwrite(data, 1, size, file);
+    offset += size;
+
+    uint64_t aligned = AlignOffset(offset);
+    fwrite(ZEROS, 1, size_t(aligned - offset), file);
+    offset = aligned;
+}
+
+bool MeshCache::Write(const char* path, const MeshData& data)
+{
+    const unsigned int vertex_count = data.GetVertexCount();
+    const unsigned int index_count = (unsigned int)data.indices.size();
+
+    MeshCacheHeader header = {};
+    memcpy(header.magic, MESH_CACHE_MAGIC, sizeof(header.magic));
+    header.version = VERSION;
+    header.byte_order = MESH_CACHE_BYTE_ORDER;
+    header.vertex_count = vertex_count;
+    header.vertex_stride = data.vertex_stride;
+    header.index_count = index_count;
+    header.attrib_count = data.attrib_count;
+
+    header.index_type = GetCompactIndexType(GetMaxIndex(data.indices.data(), index_count));
+
+    glm::vec3 bounds_min(0.f), bounds_max(0.f);
+    for (unsigned int i = 0; i < vertex_count; ++i)
+    {
+        const float* position = data.GetPosition(i);
+        glm::vec3 p(position[0], position[1], position[2]);
+        bounds_min = i == 0 ? p : glm::min(bounds_min, p);
+        bounds_max = i == 0 ? p : glm::max(bounds_max, p);
+    }
+    memcpy(header.bounds_min, &bounds_min.x, sizeof(header.bounds_min));
+    memcpy(header.bounds_max, &bounds_max.x, sizeof(header.bounds_max));
+
+    std::vector<MeshCacheAttrib> attribs(data.attrib_count);
+    for (unsigned int i = 0; i < data.attrib_count; ++i)
+    {
+        attribs[i].dims = (uint32_t)data.attribs[i].dims;
+        attribs[i].offset = (uint32_t)data.attribs[i].offset;
+        attribs[i].type = data.attribs[i].type;
+        attribs[i].normalized = data.attribs[i].normalized;
+        attribs[i].integer = data.attribs[i].integer;
+    }
+
+    std::vector<MeshLod> lods = data.lods;
+    if (lods.empty())
+        lods.push_back({ 0, index_count, 0.f });
+    header.lod_count = (uint32_t)lods.size();
+
+    std::vector<unsigned char> indices(index_count * GetIndexTypeSize(header.index_type));
+    ConvertIndices(data.indices.data(), index_count, header.index_type, indices.data());
+
+    header.attribs_offset = AlignOffset(sizeof(header));
+    header.lods_offset = AlignOffset(header.attribs_offset + attribs.size() * sizeof(MeshCacheAttrib));
+    header.vertices_offset = AlignOffset(header.lods_offset + lods.size() * sizeof(MeshLod));
+    header.indices_offset = AlignOffset(header.vertices_offset + data.vertices.size());
+
+    FILE* file = fopen(path, "wb");
+    if (!file)
+    {
+        std::cout << "Failed to open mesh cache for writing: " << path << std::endl;
+        return false;
+    }
+
+    uint64_t offset = 0;
+    WritePadded(file, &header, sizeof(header), offset);
+    WritePadded(file, attribs.data(), attribs.size() * sizeof(MeshCacheAttrib), offset);
+    WritePadded(file, lods.data(), lods.size() * sizeof(MeshLod), offset);
+    WritePadded(file, data.vertices.data(), data.vertices.size(), offset);
+    WritePadded(file, indices.data(), indices.size(), offset);
+
+    bool success = !ferror(file);
+    success = fclose(file) == 0 && success;
+    if (!success)
+        std::cout << "Failed to write mesh cache: " << path << std::endl;
+
+    return success;
+}
+
+static inline bool IsRangeValid(uint64_t offset, uint64_t size, uint64_t file_size)
+{
+    return offset <= file_size && size <= file_size - offset;
+}
+
+MeshCache* MeshCache::CreateFromFile(const char* path)
+{
+    MappedFile* file = MappedFile::Open(path);
+    if (!file)
+        return nullptr;
+
+    const unsigned char* data = (const unsigned char*)file->GetData();
+    const uint64_t size = file->GetSize();
+
+    MeshCacheHeader header = {};
+    if (size >= sizeof(header))
+        memcpy(&header, data, sizeof(header));
+
+    if (memcmp(header.magic, MESH_CACHE_MAGIC, sizeof(header.magic)) != 0 || header.version != VERSION ||
+        header.byte_order != MESH_CACHE_BYTE_ORDER)
+    {
+        std::cout << "Not a mesh cache of version " << VERSION << " in this host's byte order: " << path << std::endl;
+        delete file;
+        return nullptr;
+    }
+
+    const uint64_t vertices_size = uint64_t(header.vertex_count) * header.vertex_stride;
+    const uint64_t indices_size = uint64_t(header.index_count) * GetIndexTypeSize(header.index_type);
+    bool is_index_type_valid = header.index_type == GL_UNSIGNED_BYTE || header.index_type == GL_UNSIGNED_SHORT ||
+        header.index_type == GL_UNSIGNED_INT;
+    if (!is_index_type_valid || header.attrib_count > MeshData::MAX_ATTRIBS ||
+        !IsRangeValid(header.attribs_offset, uint64_t(header.attrib_count) * sizeof(MeshCacheAttrib), size) ||
+        !IsRangeValid(header.lods_offset, uint64_t(header.lod_count) * sizeof(MeshLod), size) ||
+        !IsRangeValid(header.vertices_offset, vertices_size, size) ||
+        !IsRangeValid(header.indices_offset, indices_size, size))
+    {
+        std::cout << "Corrupt mesh cache: " << path << std::endl;
+        delete file;
+        return nullptr;
+    }
+
+    MeshCache* result = new MeshCache;
+    result->vertex_count = header.vertex_count;
+    result->bounds_min = glm::vec3(header.bounds_min[0], header.bounds_min[1], header.bounds_min[2]);
+    result->bounds_max = glm::vec3(header.bounds_max[0], header.bounds_max[1], header.bounds_max[2]);
+
+    result->lods.resize(header.lod_count);
+    memcpy(result->lods.data(), data + header.lods_offset, header.lod_count * sizeof(MeshLod));
+
+    for (const MeshLod& lod : result->lods)
+    {
+        if (lod.first_index > header.index_count || lod.index_count > header.index_count - lod.first_index)
+        {
+            std::cout << "Corrupt mesh cache, LOD out of range: " << path << std::endl;
+            delete result;
+            delete file;
+            return nullptr;
+        }
+    }
+
+    VertexAttribs attribs[MeshData::MAX_ATTRIBS] = {};
+    for (uint32_t i = 0; i < header.attrib_count; ++i)
+    {
+        MeshCacheAttrib attrib;
+        memcpy(&attrib, data + header.attribs_offset + i * sizeof(MeshCacheAttrib), sizeof(attrib));
+
+        attribs[i].dims = (GLint)attrib.dims;
+        attribs[i].offset = attrib.offset;
+        attribs[i].type = attrib.type;
+        attribs[i].normalized = attrib.normalized;
+        attribs[i].integer = attrib.integer != 0;
+    }
+
+    // Straight from the mapping, the pages get faulted in while the driver copies them
+    result->vbo = new VertexBuffer(data + header.vertices_offset, (size_t)vertices_size);
+    result->ibo = new IndexBuffer(data + header.indices_offset, header.index_count, header.index_type);
+    result->vao = new VertexArray(result->vbo, result->ibo, attribs, header.attrib_count, header.vertex_stride);
+
+    delete file;
+    return result;
+}
+
+MeshCache::~MeshCache()
+{
+    delete vao;
+    delete ibo;
+    delete vbo;
+}
+}   // namespace Ogle
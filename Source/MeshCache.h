@@ -0,0 +1,39 @@
+#ifndef MESH_CACHE_H
+
+#include "MeshData.h"
+
+#include <glm/glm.hpp>
+#include <vector>
+
+namespace Ogle
+{
+// Binary mesh container which can be uploaded straight from a memory mapping, to skip re-importing source meshes.
+// Layout: MeshCacheHeader, then at 16 byte aligned offsets given by the header the vertex attributes, the LOD table,
+// the interleaved vertices and the indices (narrowest index type). All in the writing host's byte order, the header
+// has a marker to reject caches from a host with the other one.
+struct MeshCache
+{
+    static const uint32_t VERSION = 2;
+
+    // Returns false if the file couldn't be written
+    static bool Write(const char* path, const MeshData& data);
+
+    // Returns nullptr if the file is missing, invalid or has another version, i.e. when it should be rebuilt
+    static MeshCache* CreateFromFile(const char* path);
+    ~MeshCache();
+
+    VertexBuffer* vbo = nullptr;
+    IndexBuffer* ibo = nullptr;
+    VertexArray* vao = nullptr;
+
+    std::vector<MeshLod> lods;
+    unsigned int vertex_count = 0;
+
+    // Of the positions
+    glm::vec3 bounds_min;
+    glm::vec3 bounds_max;
+};
+}   // namespace Ogle
+
+#define MESH_CACHE_H
+#endif
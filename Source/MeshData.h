@@ -0,0 +1,44 @@
+#ifndef MESH_DATA_H
+
+#include "Mesh.h"
+
+#include <vector>
+
+namespace Ogle
+{
+// Range of the index buffer making up one level of detail, error is the geometric deviation from LOD 0
+struct MeshLod
+{
+    unsigned int first_index;
+    unsigned int index_count;
+    float error;
+};
+
+// CPU side mesh with interleaved vertices, ready to be uploaded with VertexBuffer, IndexBuffer and VertexArray. The
+// first attribute is always the float3 position.
+struct MeshData
+{
+    static constexpr unsigned int MAX_ATTRIBS = 8;
+
+    inline unsigned int GetVertexCount() const
+    {
+        return vertex_stride ? (unsigned int)(vertices.size() / vertex_stride) : 0;
+    }
+
+    inline const float* GetPosition(unsigned int vertex) const
+    {
+        return (const float*)(vertices.data() + size_t(vertex) * vertex_stride + attribs[0].offset);
+    }
+
+    std::vector<unsigned char> vertices;
+    std::vector<unsigned int> indices;      // Triangle list
+    std::vector<MeshLod> lods;              // Empty means all indices are LOD 0
+
+    VertexAttribs attribs[MAX_ATTRIBS];
+    unsigned int attrib_count = 0;
+    unsigned int vertex_stride = 0;         // In bytes
+};
+}   // namespace Ogle
+
+#define MESH_DATA_H
+#endif
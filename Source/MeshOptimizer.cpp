@@ -0,0 +1,356 @@
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <cstring>
+#include <glm/glm.hpp>
+#include <vector>
+
+namespace Ogle
+{
+VertexCacheStatistics AnalyzeVertexCache(const unsigned int* indices, size_t index_count, unsigned int vertex_count,
+    unsigned int cache_size)
+{
+    // A vertex is in the FIFO if it was added less than cache_size insertions ago
+    std::vector<unsigned int> insertion_time(vertex_count, 0);
+    unsigned int time = cache_size + 1;
+
+    VertexCacheStatistics result = {};
+    for (size_t i = 0; i < index_count; ++i)
+    {
+        unsigned int vertex = indices[i];
+        if (time - insertion_time[vertex] > cache_size)
+        {
+            insertion_time[vertex] = time++;
+            ++result.vertices_transformed;
+        }
+    }
+
+    size_t triangle_count = index_count / 3;
+    result.acmr = triangle_count ? float(result.vertices_transformed) / float(triangle_count) : 0.f;
+    result.atvr = vertex_count ? float(result.vertices_transformed) / float(vertex_count) : 0.f;
+    return result;
+}
+
+// Triangles adjacent to every vertex, in CSR layout
+struct TriangleAdjacency
+{
+    TriangleAdjacency(const unsigned int* indices, size_t index_count, unsigned int vertex_count)
+        : offsets(vertex_count + 1, 0), triangles(index_count)
+    {
+        for (size_t i = 0; i < index_count; ++i)
+            ++offsets[indices[i] + 1];
+
+        for (unsigned int v = 0; v < vertex_count; ++v)
+            offsets[v + 1] += offsets[v];
+
+        std::vector<unsigned int> fill(offsets.begin(), offsets.end() - 1);
+        for (size_t i = 0; i < index_count; ++i)
+            triangles[fill[indices[i]]++] = (unsigned int)(i / 3);
+    }
+
+    inline unsigned int GetCount(unsigned int vertex) const { return offsets[vertex + 1] - offsets[vertex]; }
+
+    std::vector<unsigned int> offsets;
+    std::vector<unsigned int> triangles;
+};
+
+void OptimizeVertexCache(unsigned int* destination, const unsigned int* indices, size_t index_count,
+    unsigned int vertex_count, unsigned int cache_size)
+{
+    const size_t triangle_count = index_count / 3;
+    if (triangle_count == 0)
+        return;
+
+    // The input may get overwritten
+    std::vector<unsigned int> source(indices, indices + index_count);
+    indices = source.data();
+
+    TriangleAdjacency adjacency(indices, index_count, vertex_count);
+
+    std::vector<unsigned int> live_triangles(vertex_count);
+    for (unsigned int v = 0; v < vertex_count; ++v)
+        live_triangles[v] = adjacency.GetCount(v);
+
+    std::vector<unsigned int> cache_time(vertex_count, 0);
+    std::vector<bool> emitted(triangle_count, false);
+    std::vector<unsigned int> dead_end_stack;
+    std::vector<unsigned int> candidates;
+
+    unsigned int time = cache_size + 1;
+    unsigned int cursor = 1;
+    size_t output_count = 0;
+
+    int fanning_vertex = 0;
+    while (fanning_vertex >= 0)
+    {
+        candidates.clear();
+
+        // Emit every remaining triangle around the fanning vertex
+        unsigned int v = (unsigned int)fanning_vertex;
+        for (unsigned int i = adjacency.offsets[v]; i < adjacency.offsets[v + 1]; ++i)
+        {
+            unsigned int triangle = adjacency.triangles[i];
+            if (emitted[triangle])
+                continue;
+
+            for (unsigned int corner = 0; corner < 3; ++corner)
+            {
+                unsigned int vertex = indices[3 * triangle + corner];
+                destination[output_count++] = vertex;
+
+                dead_end_stack.push_back(vertex);
+                candidates.push_back(vertex);
+                --live_triangles[vertex];
+
+                if (time - cache_time[vertex] > cache_size)
+                    cache_time[vertex] = time++;
+            }
+
+            emitted[triangle] = true;
+        }
+
+        // Prefer the candidate which will still be in the cache when its remaining triangles get emitted, among
+        // those the one which entered it first
+        int best_vertex = -1;
+        int best_priority = -1;
+        for (unsigned int candidate : candidates)
+        {
+            if (live_triangles[candidate] == 0)
+                continue;
+
+            int priority = 0;
+            if (time - cache_time[candidate] + 2 * live_triangles[candidate] <= cache_size)
+                priority = int(time - cache_time[candidate]);
+
+            if (priority > best_priority)
+            {
+                best_priority = priority;
+                best_vertex = int(candidate);
+            }
+        }
+
+        if (best_vertex == -1)
+        {
+            // Dead end, back track to a recently used vertex with triangles left, or else the next in input order
+            while (!dead_end_stack.empty())
+            {
+                unsigned int vertex = dead_end_stack.back();
+                dead_end_stack.pop_back();
+                if (live_triangles[vertex] > 0)
+                {
+                    best_vertex = int(vertex);
+                    break;
+                }
+            }
+
+            while (best_vertex == -1 && cursor < vertex_count)
+            {
+                if (live_triangles[cursor] > 0)
+                    best_vertex = int(cursor);
+                ++cursor;
+            }
+        }
+
+        fanning_vertex = best_vertex;
+    }
+}
+
+void OptimizeOverdraw(unsigned int* destination, const unsigned int* indices, size_t index_count,
+    const float* positions, size_t vertex_stride, unsigned int vertex_count, unsigned int cache_size,
+    float threshold)
+{
+    const size_t triangle_count = index_count / 3;
+    if (triangle_count == 0)
+        return;
+
+    auto get_position = [positions, vertex_stride](unsigned int vertex)
+    {
+        const float* p = (const float*)((const unsigned char*)positions + vertex * vertex_stride);
+        return glm::vec3(p[0], p[1], p[2]);
+    };
+
+    // Hard boundaries are where the cache restarts, i.e. a triangle misses on all its vertices
+    std::vector<unsigned int> cache_time(vertex_count, 0);
+    unsigned int time = cache_size + 1;
+    std::vector<unsigned int> triangle_misses(triangle_count);
+    for (size_t t = 0; t < triangle_count; ++t)
+    {
+        unsigned int misses = 0;
+        for (unsigned int corner = 0; corner < 3; ++corner)
+        {
+            unsigned int vertex = indices[3 * t + corner];
+            if (time - cache_time[vertex] > cache_size)
+            {
+                cache_time[vertex] = time++;
+                ++misses;
+            }
+        }
+        triangle_misses[t] = misses;
+    }
+
+    std::vector<size_t> hard_boundaries;
+    for (size_t t = 0; t < triangle_count; ++t)
+    {
+        if (t == 0 || triangle_misses[t] == 3)
+            hard_boundaries.push_back(t);
+    }
+    hard_boundaries.push_back(triangle_count);
+
+    // Soft boundaries split the hard clusters further wherever the cluster so far, drawn with a cold cache, is
+    // within threshold of the hard cluster's ACMR
+    std::vector<size_t> cluster_starts;
+    for (size_t h = 0; h + 1 < hard_boundaries.size(); ++h)
+    {
+        size_t begin = hard_boundaries[h];
+        size_t end = hard_boundaries[h + 1];
+
+        unsigned int total_misses = 0;
+        for (size_t t = begin; t < end; ++t)
+            total_misses += triangle_misses[t];
+        const float target_acmr = threshold * float(total_misses) / float(end - begin);
+
+        cluster_starts.push_back(begin);
+
+        // Advancing the time past the cache size empties the cache
+        time += cache_size + 1;
+        unsigned int misses = 0;
+        size_t start = begin;
+        for (size_t t = begin; t < end; ++t)
+        {
+            for (unsigned int corner = 0; corner < 3; ++corner)
+            {
+                unsigned int vertex = indices[3 * t + corner];
+                if (time - cache_time[vertex] > cache_size)
+                {
+                    cache_time[vertex] = time++;
+                    ++misses;
+                }
+            }
+
+            if (t + 1 < end && float(misses) / float(t - start + 1) <= target_acmr)
+            {
+                cluster_starts.push_back(t + 1);
+                start = t + 1;
+                misses = 0;
+                time += cache_size + 1;
+            }
+        }
+    }
+    cluster_starts.push_back(triangle_count);
+
+    const size_t cluster_count = cluster_starts.size() - 1;
+
+    // Area weighted centroids and normals, a cluster facing away from the mesh centroid is likely to occlude
+    glm::vec3 mesh_centroid(0.f);
+    float mesh_area = 0.f;
+    std::vector<glm::vec3> cluster_centroids(cluster_count, glm::vec3(0.f));
+    std::vector<glm::vec3> cluster_normals(cluster_count, glm::vec3(0.f));
+    for (size_t c = 0; c < cluster_count; ++c)
+    {
+        float cluster_area = 0.f;
+        for (size_t t = cluster_starts[c]; t < cluster_starts[c + 1]; ++t)
+        {
+            glm::vec3 p0 = get_position(indices[3 * t + 0]);
+            glm::vec3 p1 = get_position(indices[3 * t + 1]);
+            glm::vec3 p2 = get_position(indices[3 * t + 2]);
+
+            glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+            float area = glm::length(normal);
+            glm::vec3 centroid = (p0 + p1 + p2) / 3.f;
+
+            cluster_centroids[c] += centroid * area;
+            cluster_normals[c] += normal;
+            cluster_area += area;
+        }
+
+        mesh_centroid += cluster_centroids[c];
+        mesh_area += cluster_area;
+
+        if (cluster_area > 0.f)
+            cluster_centroids[c] /= cluster_area;
+
+        float normal_length = glm::length(cluster_normals[c]);
+        if (normal_length > 0.f)
+            cluster_normals[c] /= normal_length;
+    }
+    if (mesh_area > 0.f)
+        mesh_centroid /= mesh_area;
+
+    std::vector<float> sort_keys(cluster_count);
+    std::vector<unsigned int> cluster_order(cluster_count);
+    for (size_t c = 0; c < cluster_count; ++c)
+    {
+        sort_keys[c] = glm::dot(cluster_centroids[c] - mesh_centroid, cluster_normals[c]);
+        cluster_order[c] = (unsigned int)c;
+    }
+
+    std::stable_sort(cluster_order.begin(), cluster_order.end(),
+        [&sort_keys](unsigned int a, unsigned int b) { return sort_keys[a] > sort_keys[b]; });
+
+    size_t output_count = 0;
+    for (unsigned int c : cluster_order)
+    {
+        size_t begin = cluster_starts[c] * 3;
+        size_t end = cluster_starts[c + 1] * 3;
+        memcpy(destination + output_count, indices + begin, (end - begin) * sizeof(unsigned int));
+        output_count += end - begin;
+    }
+}
+
+unsigned int OptimizeVertexFetch(void* destination_vertices, unsigned int* indices, size_t index_count,
+    const void* vertices, unsigned int vertex_count, size_t vertex_stride)
+{
+    const unsigned int UNUSED = ~0u;
+    std::vector<unsigned int> remap(vertex_count, UNUSED);
+
+    unsigned int next_vertex = 0;
+    for (size_t i = 0; i < index_count; ++i)
+    {
+        unsigned int& new_index = remap[indices[i]];
+        if (new_index == UNUSED)
+        {
+            new_index = next_vertex++;
+            memcpy((unsigned char*)destination_vertices + new_index * vertex_stride,
+                (const unsigned char*)vertices + indices[i] * vertex_stride, vertex_stride);
+        }
+
+        indices[i] = new_index;
+    }
+
+    return next_vertex;
+}
+
+MeshOptimizationReport OptimizeMesh(MeshData& mesh, unsigned int cache_size)
+{
+    const unsigned int vertex_count = mesh.GetVertexCount();
+
+    std::vector<MeshLod> lods = mesh.lods;
+    if (lods.empty())
+        lods.push_back({ 0, (unsigned int)mesh.indices.size(), 0.f });
+
+    MeshOptimizationReport report;
+    report.before = AnalyzeVertexCache(mesh.indices.data() + lods[0].first_index, lods[0].index_count, vertex_count,
+        cache_size);
+
+    std::vector<unsigned int> cache_optimized;
+    for (const MeshLod& lod : lods)
+    {
+        unsigned int* lod_indices = mesh.indices.data() + lod.first_index;
+
+        cache_optimized.resize(lod.index_count);
+        OptimizeVertexCache(cache_optimized.data(), lod_indices, lod.index_count, vertex_count, cache_size);
+        OptimizeOverdraw(lod_indices, cache_optimized.data(), lod.index_count, mesh.GetPosition(0), mesh.vertex_stride,
+            vertex_count, cache_size);
+    }
+
+    std::vector<unsigned char> vertices(mesh.vertices.size());
+    unsigned int new_vertex_count = OptimizeVertexFetch(vertices.data(), mesh.indices.data(), mesh.indices.size(),
+        mesh.vertices.data(), vertex_count, mesh.vertex_stride);
+    vertices.resize(size_t(new_vertex_count) * mesh.vertex_stride);
+    mesh.vertices.swap(vertices);
+
+    report.after = AnalyzeVertexCache(mesh.indices.data() + lods[0].first_index, lods[0].index_count,
+        new_vertex_count, cache_size);
+    return report;
+}
+}   // namespace Ogle
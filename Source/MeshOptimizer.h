@@ -0,0 +1,48 @@
+#ifndef MESH_OPTIMIZER_H
+
+#include "MeshData.h"
+
+#include <cstddef>
+
+namespace Ogle
+{
+struct VertexCacheStatistics
+{
+    unsigned int vertices_transformed;
+    float acmr;     // Average cache miss ratio, transformed vertices per triangle (0.5 at best, 3 at worst)
+    float atvr;     // Average transformed vertex ratio, transformed vertices per vertex (1 at best)
+};
+
+// Simulates a FIFO post-transform vertex cache
+VertexCacheStatistics AnalyzeVertexCache(const unsigned int* indices, size_t index_count, unsigned int vertex_count,
+    unsigned int cache_size = 16);
+
+// Reorders the triangles for the post-transform vertex cache with Tipsify [Sander et al. 2007]. destination may be
+// the same as indices.
+void OptimizeVertexCache(unsigned int* destination, const unsigned int* indices, size_t index_count,
+    unsigned int vertex_count, unsigned int cache_size = 16);
+
+// Reorders vertex cache optimized triangles to reduce overdraw, by splitting them into clusters where that costs at
+// most threshold times the ACMR and drawing the outward facing clusters first [Sander et al. 2007]. positions are
+// float3 at vertex_stride bytes apart. destination may not be the same as indices.
+void OptimizeOverdraw(unsigned int* destination, const unsigned int* indices, size_t index_count,
+    const float* positions, size_t vertex_stride, unsigned int vertex_count, unsigned int cache_size = 16,
+    float threshold = 1.05f);
+
+// Reorders the vertices in the order the indices first use them and remaps the indices in place. Unreferenced
+// vertices get dropped, returns the new vertex count. destination_vertices may not be the same as vertices.
+unsigned int OptimizeVertexFetch(void* destination_vertices, unsigned int* indices, size_t index_count,
+    const void* vertices, unsigned int vertex_count, size_t vertex_stride);
+
+struct MeshOptimizationReport
+{
+    VertexCacheStatistics before;
+    VertexCacheStatistics after;
+};
+
+// Runs all of the above on a mesh, each LOD's triangles are reordered separately. The statistics are for LOD 0.
+MeshOptimizationReport OptimizeMesh(MeshData& mesh, unsigned int cache_size = 16);
+}   // namespace Ogle
+
+#define MESH_OPTIMIZER_H
+#endif
@@ -0,0 +1,575 @@
+#include "MeshSimplifier.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace Ogle
+{
+// Open border edges get an extra plane perpendicular to their triangle, weighted by this, to keep the outline
+static const float BORDER_WEIGHT = 10.f;
+
+static const float NO_COLLAPSE = 3.402823466e+38f;
+
+enum class VertexKind : uint8_t
+{
+    Manifold,       // Collapses onto any neighbour
+    Border,         // Only collapses along the border
+    Locked          // Seams and non-manifold geometry
+};
+
+// Sum of squared distances to planes, stored as the symmetric 4x4 matrix of (n, d)(n, d)^T
+struct Quadric
+{
+    void AddPlane(const glm::vec3& n, float d, float weight)
+    {
+        a00 += weight * n.x * n.x;
+        a11 += weight * n.y * n.y;
+        a22 += weight * n.z * n.z;
+        a10 += weight * n.y * n.x;
+        a20 += weight * n.z * n.x;
+        a21 += weight * n.z * n.y;
+        b0 += weight * n.x * d;
+        b1 += weight * n.y * d;
+        b2 += weight * n.z * d;
+        c += weight * d * d;
+        w += weight;
+    }
+
+    void Add(const Quadric& other)
+    {
+        a00 += other.a00; a11 += other.a11; a22 += other.a22;
+        a10 += other.a10; a20 += other.a20; a21 += other.a21;
+        b0 += other.b0; b1 += other.b1; b2 += other.b2;
+        c += other.c;
+        w += other.w;
+    }
+
+    // Weighted mean squared distance of p to the planes
+    float GetError(const glm::vec3& p) const
+    {
+        double x = p.x, y = p.y, z = p.z;
+        double error = a00 * x * x + a11 * y * y + a22 * z * z + 2.0 * (a10 * x * y + a20 * x * z + a21 * y * z) +
+            2.0 * (b0 * x + b1 * y + b2 * z) + c;
+        return w > 0.0 ? float(std::fabs(error) / w) : 0.f;
+    }
+
+    double a00 = 0.0, a11 = 0.0, a22 = 0.0, a10 = 0.0, a20 = 0.0, a21 = 0.0;
+    double b0 = 0.0, b1 = 0.0, b2 = 0.0;
+    double c = 0.0;
+    double w = 0.0;
+};
+
+struct Collapse
+{
+    unsigned int from;      // Vertex indices
+    unsigned int to;
+    float error;
+};
+
+// Triangles around every position, in CSR layout
+struct PositionAdjacency
+{
+    void Build(const unsigned int* indices, size_t index_count, const unsigned int* position_ids,
+        unsigned int position_count)
+    {
+        offsets.assign(position_count + 1, 0);
+        for (size_t i = 0; i < index_count; ++i)
+            ++offsets[position_ids[indices[i]] + 1];
+
+        for (unsigned int p = 0; p < position_count; ++p)
+            offsets[p + 1] += offsets[p];
+
+        triangles.resize(index_count);
+        fill.assign(offsets.begin(), offsets.end() - 1);
+        for (size_t i = 0; i < index_count; ++i)
+            triangles[fill[position_ids[indices[i]]]++] = (unsigned int)(i / 3);
+    }
+
+    std::vector<unsigned int> offsets;
+    std::vector<unsigned int> triangles;
+    std::vector<unsigned int> fill;
+};
+
+struct Simplifier
+{
+    Simplifier(const float* positions_, size_t vertex_stride_, unsigned int vertex_count_)
+        : positions(positions_), vertex_stride(vertex_stride_), vertex_count(vertex_count_)
+    {
+        BuildPositionIds();
+    }
+
+    inline glm::vec3 GetPosition(unsigned int vertex) const
+    {
+        const float* p = (const float*)((const unsigned char*)positions + vertex * vertex_stride);
+        return glm::vec3(p[0], p[1], p[2]);
+    }
+
+    // Vertices with bitwise equal positions share an id
+    void BuildPositionIds()
+    {
+        std::vector<unsigned int> order(vertex_count);
+        for (unsigned int v = 0; v < vertex_count; ++v)
+            order[v] = v;
+
+        auto less = [this](unsigned int a, unsigned int b)
+        {
+            const float* pa = (const float*)((const unsigned char*)positions + a * vertex_stride);
+            const float* pb = (const float*)((const unsigned char*)positions + b * vertex_stride);
+            return memcmp(pa, pb, 3 * sizeof(float)) < 0;
+        };
+        std::sort(order.begin(), order.end(), less);
+
+        position_ids.resize(vertex_count);
+        position_vertex_counts.clear();
+        for (unsigned int i = 0; i < vertex_count; ++i)
+        {
+            if (i == 0 || less(order[i - 1], order[i]))
+                position_vertex_counts.push_back(0);
+
+            position_ids[order[i]] = (unsigned int)position_vertex_counts.size() - 1;
+            ++position_vertex_counts.back();
+        }
+
+        position_count = (unsigned int)position_vertex_counts.size();
+    }
+
+    void ClassifyVertices(const unsigned int* indices, size_t index_count)
+    {
+        kinds.assign(position_count, VertexKind::Manifold);
+
+        // Seams
+        for (unsigned int p = 0; p < position_count; ++p)
+        {
+            if (position_vertex_counts[p] > 1)
+                kinds[p] = VertexKind::Locked;
+        }
+
+        // Directed edges between positions, an edge without its opposite is on a border
+        std::vector<uint64_t> edges;
+        edges.reserve(index_count);
+        for (size_t i = 0; i < index_count; i += 3)
+        {
+            for (unsigned int e = 0; e < 3; ++e)
+            {
+                unsigned int a = position_ids[indices[i + e]];
+                unsigned int b = position_ids[indices[i + (e + 1) % 3]];
+                edges.push_back((uint64_t(a) << 32) | b);
+            }
+        }
+        std::sort(edges.begin(), edges.end());
+
+        auto count_edge = [&edges](unsigned int a, unsigned int b)
+        {
+            auto range = std::equal_range(edges.begin(), edges.end(), (uint64_t(a) << 32) | b);
+            return size_t(range.second - range.first);
+        };
+
+        std::vector<unsigned int> border_edge_counts(position_count, 0);
+        border_next.assign(position_count, ~0u);
+        border_previous.assign(position_count, ~0u);
+        for (size_t i = 0; i < edges.size(); ++i)
+        {
+            unsigned int a = (unsigned int)(edges[i] >> 32);
+            unsigned int b = (unsigned int)(edges[i] & 0xffffffff);
+
+            // Repeated directed edges mean non-manifold or inconsistently wound geometry
+            if ((i > 0 && edges[i - 1] == edges[i]) || count_edge(b, a) > 1)
+            {
+                kinds[a] = VertexKind::Locked;
+                kinds[b] = VertexKind::Locked;
+                continue;
+            }
+
+            if (count_edge(b, a) == 0)
+            {
+                ++border_edge_counts[a];
+                border_next[a] = b;
+                border_previous[b] = a;
+            }
+        }
+
+        for (unsigned int p = 0; p < position_count; ++p)
+        {
+            if (kinds[p] != VertexKind::Manifold)
+                continue;
+
+            // A border vertex is on exactly one border loop
+            if (border_edge_counts[p] == 1)
+                kinds[p] = VertexKind::Border;
+            else if (border_edge_counts[p] > 1)
+                kinds[p] = VertexKind::Locked;
+        }
+
+        for (unsigned int p = 0; p < position_count; ++p)
+        {
+            if (kinds[p] == VertexKind::Border && border_next[p] != ~0u && kinds[border_next[p]] == VertexKind::Manifold)
+                kinds[p] = VertexKind::Locked;
+        }
+    }
+
+    // Needs the border from ClassifyVertices
+    void ComputeQuadrics(const unsigned int* indices, size_t index_count)
+    {
+        quadrics.assign(position_count, Quadric());
+
+        for (size_t i = 0; i < index_count; i += 3)
+        {
+            glm::vec3 p[3];
+            for (unsigned int corner = 0; corner < 3; ++corner)
+                p[corner] = GetPosition(indices[i + corner]);
+
+            glm::vec3 normal = glm::cross(p[1] - p[0], p[2] - p[0]);
+            float area = glm::length(normal);
+            if (area == 0.f)
+                continue;
+
+            normal /= area;
+            float d = -glm::dot(normal, p[0]);
+
+            for (unsigned int corner = 0; corner < 3; ++corner)
+                quadrics[position_ids[indices[i + corner]]].AddPlane(normal, d, area);
+
+            // Border edges also get a plane through them perpendicular to the triangle
+            for (unsigned int e = 0; e < 3; ++e)
+            {
+                unsigned int a = position_ids[indices[i + e]];
+                unsigned int b = position_ids[indices[i + (e + 1) % 3]];
+                if (border_next[a] != b)
+                    continue;
+
+                glm::vec3 edge = p[(e + 1) % 3] - p[e];
+                float length = glm::length(edge);
+                if (length == 0.f)
+                    continue;
+
+                glm::vec3 border_normal = glm::cross(edge / length, normal);
+                float border_d = -glm::dot(border_normal, p[e]);
+                quadrics[a].AddPlane(border_normal, border_d, BORDER_WEIGHT * length * length);
+                quadrics[b].AddPlane(border_normal, border_d, BORDER_WEIGHT * length * length);
+            }
+        }
+    }
+
+    bool CanCollapse(unsigned int from, unsigned int to) const
+    {
+        unsigned int p0 = position_ids[from];
+        unsigned int p1 = position_ids[to];
+        if (p0 == p1)
+            return false;
+
+        switch (kinds[p0])
+        {
+            case VertexKind::Manifold: return true;
+            case VertexKind::Border: return border_next[p0] == p1 || border_next[p1] == p0;
+            default: return false;
+        }
+    }
+
+    // Link condition (the collapse must not pinch the surface) and no triangle around from may flip
+    bool IsCollapseValid(const Collapse& collapse, const unsigned int* indices)
+    {
+        const unsigned int p0 = position_ids[collapse.from];
+        const unsigned int p1 = position_ids[collapse.to];
+        const glm::vec3 from_position = GetPosition(collapse.from);
+        const glm::vec3 to_position = GetPosition(collapse.to);
+
+        ring0.clear();
+        ring1.clear();
+        unsigned int edge_triangle_count = 0;
+
+        for (unsigned int i = adjacency.offsets[p0]; i < adjacency.offsets[p0 + 1]; ++i)
+        {
+            const unsigned int* triangle = indices + 3 * adjacency.triangles[i];
+
+            bool has_to = false;
+            unsigned int from_corner = 0;
+            for (unsigned int corner = 0; corner < 3; ++corner)
+            {
+                unsigned int p = position_ids[triangle[corner]];
+                has_to = has_to || p == p1;
+                from_corner = p == p0 ? corner : from_corner;
+                if (p != p0)
+                    ring0.push_back(p);
+            }
+
+            if (has_to)
+            {
+                ++edge_triangle_count;
+                continue;
+            }
+
+            glm::vec3 a = GetPosition(triangle[(from_corner + 1) % 3]);
+            glm::vec3 b = GetPosition(triangle[(from_corner + 2) % 3]);
+            glm::vec3 normal_before = glm::cross(a - from_position, b - from_position);
+            glm::vec3 normal_after = glm::cross(a - to_position, b - to_position);
+
+            // Reject flips and near degenerate results
+            if (glm::dot(normal_before, normal_after) <= 0.25f * glm::length(normal_before) * glm::length(normal_after))
+                return false;
+        }
+
+        for (unsigned int i = adjacency.offsets[p1]; i < adjacency.offsets[p1 + 1]; ++i)
+        {
+            const unsigned int* triangle = indices + 3 * adjacency.triangles[i];
+            for (unsigned int corner = 0; corner < 3; ++corner)
+            {
+                unsigned int p = position_ids[triangle[corner]];
+                if (p != p1)
+                    ring1.push_back(p);
+            }
+        }
+
+        std::sort(ring0.begin(), ring0.end());
+        ring0.erase(std::unique(ring0.begin(), ring0.end()), ring0.end());
+        std::sort(ring1.begin(), ring1.end());
+        ring1.erase(std::unique(ring1.begin(), ring1.end()), ring1.end());
+
+        unsigned int shared_count = 0;
+        for (size_t i = 0, j = 0; i < ring0.size() && j < ring1.size();)
+        {
+            if (ring0[i] < ring1[j])
+            {
+                ++i;
+            }
+            else if (ring1[j] < ring0[i])
+            {
+                ++j;
+            }
+            else
+            {
+                ++shared_count;
+                ++i;
+                ++j;
+            }
+        }
+
+        return edge_triangle_count > 0 && shared_count == edge_triangle_count;
+    }
+
+    // Collapses the cheapest non-overlapping edges, returns how many triangles got removed
+    size_t CollapseEdges(std::vector<unsigned int>& indices, size_t triangles_to_remove, float max_error,
+        float& result_error)
+    {
+        adjacency.Build(indices.data(), indices.size(), position_ids.data(), position_count);
+
+        collapses.clear();
+        for (size_t i = 0; i < indices.size(); i += 3)
+        {
+            for (unsigned int e = 0; e < 3; ++e)
+            {
+                unsigned int a = indices[i + e];
+                unsigned int b = indices[i + (e + 1) % 3];
+
+                // Each edge appears in both of its triangles, only consider it from the one with a < b (by position)
+                // unless it's a border edge
+                unsigned int pa = position_ids[a], pb = position_ids[b];
+                if (pa > pb && border_next[pa] != pb)
+                    continue;
+
+                Collapse best = { 0, 0, NO_COLLAPSE };
+                if (CanCollapse(a, b))
+                    best = { a, b, quadrics[pa].GetError(GetPosition(b)) };
+                if (CanCollapse(b, a))
+                {
+                    float error = quadrics[pb].GetError(GetPosition(a));
+                    if (error < best.error)
+                        best = { b, a, error };
+                }
+
+                if (best.error != NO_COLLAPSE)
+                    collapses.push_back(best);
+            }
+        }
+
+        std::sort(collapses.begin(), collapses.end(),
+            [](const Collapse& a, const Collapse& b) { return a.error < b.error; });
+
+        locked.assign(position_count, false);
+        remap.resize(vertex_count);
+        for (unsigned int v = 0; v < vertex_count; ++v)
+            remap[v] = v;
+
+        const float max_squared_error = max_error * max_error;
+        size_t removed_triangle_count = 0;
+        for (const Collapse& collapse : collapses)
+        {
+            if (removed_triangle_count >= triangles_to_remove || collapse.error > max_squared_error)
+                break;
+
+            unsigned int p0 = position_ids[collapse.from];
+            unsigned int p1 = position_ids[collapse.to];
+            if (locked[p0] || locked[p1] || !IsCollapseValid(collapse, indices.data()))
+                continue;
+
+            remap[collapse.from] = collapse.to;
+            quadrics[p1].Add(quadrics[p0]);
+            // Keep the border loop linked around the removed vertex
+            if (kinds[p0] == VertexKind::Border)
+            {
+                unsigned int previous = border_previous[p0];
+                unsigned int next = border_next[p0];
+                if (next == p1 && previous != ~0u)
+                {
+                    border_next[previous] = p1;
+                    border_previous[p1] = previous;
+                }
+                else if (previous == p1 && next != ~0u)
+                {
+                    border_next[p1] = next;
+                    border_previous[next] = p1;
+                }
+            }
+
+            // The neighbourhood's adjacency is out of date now
+            locked[p0] = locked[p1] = true;
+            for (unsigned int p : ring0)
+                locked[p] = true;
+
+            for (unsigned int i = adjacency.offsets[p0]; i < adjacency.offsets[p0 + 1]; ++i)
+            {
+                const unsigned int* triangle = indices.data() + 3 * adjacency.triangles[i];
+                for (unsigned int corner = 0; corner < 3; ++corner)
+                    removed_triangle_count += position_ids[triangle[corner]] == p1;
+            }
+
+            result_error = std::max(result_error, collapse.error);
+        }
+
+        if (removed_triangle_count == 0)
+            return 0;
+
+        // Apply, dropping the triangles which became degenerate
+        size_t write = 0;
+        for (size_t i = 0; i < indices.size(); i += 3)
+        {
+            unsigned int a = remap[indices[i + 0]];
+            unsigned int b = remap[indices[i + 1]];
+            unsigned int c = remap[indices[i + 2]];
+
+            unsigned int pa = position_ids[a], pb = position_ids[b], pc = position_ids[c];
+            if (pa == pb || pb == pc || pc == pa)
+                continue;
+
+            indices[write++] = a;
+            indices[write++] = b;
+            indices[write++] = c;
+        }
+
+        size_t removed = (indices.size() - write) / 3;
+        indices.resize(write);
+        return removed;
+    }
+
+    const float* positions;
+    size_t vertex_stride;
+    unsigned int vertex_count;
+
+    std::vector<unsigned int> position_ids;
+    std::vector<unsigned int> position_vertex_counts;
+    unsigned int position_count = 0;
+
+    std::vector<VertexKind> kinds;
+    std::vector<unsigned int> border_next;      // Neighbouring positions along the border loop
+    std::vector<unsigned int> border_previous;
+    std::vector<Quadric> quadrics;
+
+    PositionAdjacency adjacency;
+    std::vector<Collapse> collapses;
+    std::vector<bool> locked;
+    std::vector<unsigned int> remap;
+    std::vector<unsigned int> ring0;
+    std::vector<unsigned int> ring1;
+};
+
+size_t SimplifyMesh(unsigned int* destination, const unsigned int* indices, size_t index_count, const float* positions,
+    size_t vertex_stride, unsigned int vertex_count, size_t target_index_count, float target_error,
+    float* result_error)
+{
+    std::vector<unsigned int> current(indices, indices + index_count);
+
+    Simplifier simplifier(positions, vertex_stride, vertex_count);
+    simplifier.ClassifyVertices(current.data(), current.size());
+    simplifier.ComputeQuadrics(current.data(), current.size());
+
+    glm::vec3 bounds_min(0.f), bounds_max(0.f);
+    for (unsigned int v = 0; v < vertex_count; ++v)
+    {
+        glm::vec3 p = simplifier.GetPosition(v);
+        bounds_min = v == 0 ? p : glm::min(bounds_min, p);
+        bounds_max = v == 0 ? p : glm::max(bounds_max, p);
+    }
+    glm::vec3 extent = bounds_max - bounds_min;
+    const float max_error = target_error * std::max(extent.x, std::max(extent.y, extent.z));
+
+    float squared_error = 0.f;
+    const size_t target_triangle_count = target_index_count / 3;
+    while (current.size() / 3 > target_triangle_count)
+    {
+        // Every pass collapses a set of independent edges
+        size_t triangles_to_remove = current.size() / 3 - target_triangle_count;
+        if (simplifier.CollapseEdges(current, triangles_to_remove, max_error, squared_error) == 0)
+            break;
+    }
+
+    if (result_error)
+        *result_error = std::sqrt(squared_error);
+
+    memcpy(destination, current.data(), current.size() * sizeof(unsigned int));
+    return current.size();
+}
+
+void GenerateLods(MeshData& mesh, const float* ratios, unsigned int ratio_count, float target_error)
+{
+    if (mesh.lods.empty())
+        mesh.lods.push_back({ 0, (unsigned int)mesh.indices.size(), 0.f });
+
+    const unsigned int base_index_count = mesh.lods[0].index_count;
+
+    std::vector<unsigned int> lod_indices;
+    for (unsigned int i = 0; i < ratio_count; ++i)
+    {
+        const MeshLod previous = mesh.lods.back();
+        size_t target_index_count = size_t(ratios[i] * base_index_count) / 3 * 3;
+        if (target_index_count >= previous.index_count)
+            continue;
+
+        lod_indices.resize(previous.index_count);
+        float error = 0.f;
+        size_t index_count = SimplifyMesh(lod_indices.data(), mesh.indices.data() + previous.first_index,
+            previous.index_count, mesh.GetPosition(0), mesh.vertex_stride, mesh.GetVertexCount(), target_index_count,
+            target_error, &error);
+
+        // Barely simplified any further, the remaining collapses would exceed the error
+        if (index_count == 0 || index_count > previous.index_count * 95 / 100)
+            break;
+
+        // Simplifying from the previous LOD accumulates its error
+        MeshLod lod;
+        lod.first_index = (unsigned int)mesh.indices.size();
+        lod.index_count = (unsigned int)index_count;
+        lod.error = previous.error + error;
+
+        mesh.indices.insert(mesh.indices.end(), lod_indices.begin(), lod_indices.begin() + index_count);
+        mesh.lods.push_back(lod);
+    }
+}
+
+unsigned int SelectLod(const std::vector<MeshLod>& lods, const Camera& camera, const glm::vec3& center, float radius,
+    float viewport_height, float max_pixel_error)
+{
+    float distance = std::max(glm::length(center - camera.GetPosition()) - radius, camera.GetNear());
+
+    // Pixels per world unit at that distance
+    float projection_scale = viewport_height / (2.f * std::tan(glm::radians(camera.GetFovY()) * 0.5f));
+    float pixels_per_unit = projection_scale / distance;
+
+    for (unsigned int i = (unsigned int)lods.size(); i-- > 1;)
+    {
+        if (lods[i].error * pixels_per_unit <= max_pixel_error)
+            return i;
+    }
+
+    return 0;
+}
+}   // namespace Ogle
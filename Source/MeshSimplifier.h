@@ -0,0 +1,32 @@
+#ifndef MESH_SIMPLIFIER_H
+
+#include "Camera.h"
+#include "MeshData.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace Ogle
+{
+// Quadric error metric edge collapse [Garland and Heckbert 1997]. Only the indices change: a vertex collapses onto
+// one of its neighbours, so the vertex data (and attributes) stay valid. Vertices on attribute seams (several
+// vertices at the same position) or non-manifold geometry are locked, vertices on open borders only collapse along
+// the border. Stops at target_index_count or before the error would exceed target_error, relative to the mesh's
+// extent. Returns the number of indices written to destination (at most index_count), the reached error in mesh
+// units is written to result_error.
+size_t SimplifyMesh(unsigned int* destination, const unsigned int* indices, size_t index_count, const float* positions,
+    size_t vertex_stride, unsigned int vertex_count, size_t target_index_count, float target_error,
+    float* result_error = nullptr);
+
+// Appends a LOD per ratio (of LOD 0's triangle count, descending) to the mesh's indices and LOD table, each
+// simplified from the previous one. Stops early once simplification stalls. Run OptimizeMesh afterwards.
+void GenerateLods(MeshData& mesh, const float* ratios, unsigned int ratio_count, float target_error = 0.05f);
+
+// Coarsest LOD whose error projected on screen stays below max_pixel_error, for a mesh with the given bounding
+// sphere in world space
+unsigned int SelectLod(const std::vector<MeshLod>& lods, const Camera& camera, const glm::vec3& center, float radius,
+    float viewport_height, float max_pixel_error = 1.f);
+}   // namespace Ogle
+
+#define MESH_SIMPLIFIER_H
+#endif
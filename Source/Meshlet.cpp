@@ -0,0 +1,197 @@
+#include "Meshlet.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace Ogle
+{
+static const unsigned int MESHLET_CULL_BATCH_SIZE = 256;
+
+static inline glm::vec3 GetPosition(const float* positions, size_t vertex_stride, unsigned int vertex)
+{
+    const float* p = (const float*)((const unsigned char*)positions + vertex * vertex_stride);
+    return glm::vec3(p[0], p[1], p[2]);
+}
+
+static void ComputeMeshletBounds(Meshlet& meshlet, BoundingSpheres& bounds, const unsigned int* indices,
+    const float* positions, size_t vertex_stride)
+{
+    const unsigned int* meshlet_indices = indices + meshlet.first_index;
+
+    // Sphere around the center of the AABB
+    glm::vec3 bounds_min = GetPosition(positions, vertex_stride, meshlet_indices[0]);
+    glm::vec3 bounds_max = bounds_min;
+    for (unsigned int i = 1; i < meshlet.index_count; ++i)
+    {
+        glm::vec3 p = GetPosition(positions, vertex_stride, meshlet_indices[i]);
+        bounds_min = glm::min(bounds_min, p);
+        bounds_max = glm::max(bounds_max, p);
+    }
+
+    glm::vec3 center = 0.5f * (bounds_min + bounds_max);
+    float radius = 0.f;
+    for (unsigned int i = 0; i < meshlet.index_count; ++i)
+        radius = std::max(radius, glm::distance(center, GetPosition(positions, vertex_stride, meshlet_indices[i])));
+
+    bounds.Add(center, radius);
+
+    // The cone axis is the average normal, its angle is set by the normal deviating the most from it
+    std::vector<glm::vec3> normals;
+    normals.reserve(meshlet.index_count / 3);
+    glm::vec3 axis(0.f);
+    for (unsigned int i = 0; i < meshlet.index_count; i += 3)
+    {
+        glm::vec3 p0 = GetPosition(positions, vertex_stride, meshlet_indices[i + 0]);
+        glm::vec3 p1 = GetPosition(positions, vertex_stride, meshlet_indices[i + 1]);
+        glm::vec3 p2 = GetPosition(positions, vertex_stride, meshlet_indices[i + 2]);
+
+        glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+        float area = glm::length(normal);
+        normals.push_back(area > 0.f ? normal / area : glm::vec3(0.f));
+        axis += normals.back();
+    }
+
+    meshlet.cone_apex = center;
+    meshlet.cone_axis = glm::vec3(0.f, 0.f, 1.f);
+    meshlet.cone_cutoff = 2.f;
+
+    float axis_length = glm::length(axis);
+    if (axis_length == 0.f)
+        return;
+    axis /= axis_length;
+
+    float min_dot = 1.f;
+    for (const glm::vec3& normal : normals)
+        min_dot = std::min(min_dot, glm::dot(normal, axis));
+
+    // Wider than 90 degrees, some triangles always face the camera
+    if (min_dot <= 0.1f)
+        return;
+
+    // Move the apex back along the axis until every triangle's plane is in front of it
+    float max_t = 0.f;
+    for (unsigned int i = 0; i < meshlet.index_count; i += 3)
+    {
+        const glm::vec3& normal = normals[i / 3];
+        float normal_dot = glm::dot(normal, axis);
+        if (normal_dot <= 0.f)
+            continue;
+
+        glm::vec3 p0 = GetPosition(positions, vertex_stride, meshlet_indices[i]);
+        max_t = std::max(max_t, glm::dot(center - p0, normal) / normal_dot);
+    }
+
+    meshlet.cone_apex = center - axis * max_t;
+    meshlet.cone_axis = axis;
+    meshlet.cone_cutoff = std::sqrt(1.f - min_dot * min_dot);
+}
+
+void BuildMeshlets(MeshletMesh& result, const unsigned int* indices, size_t index_count, const float* positions,
+    size_t vertex_stride, unsigned int vertex_count, unsigned int max_vertices, unsigned int max_triangles)
+{
+    result.meshlets.clear();
+    result.bounds.Clear();
+
+    // Which meshlet last used a vertex, to count the unique vertices
+    std::vector<unsigned int> vertex_meshlet(vertex_count, ~0u);
+
+    Meshlet meshlet = {};
+    for (size_t i = 0; i + 2 < index_count; i += 3)
+    {
+        const unsigned int meshlet_index = (unsigned int)result.meshlets.size();
+
+        unsigned int new_vertex_count = 0;
+        for (unsigned int corner = 0; corner < 3; ++corner)
+            new_vertex_count += vertex_meshlet[indices[i + corner]] != meshlet_index;
+
+        if (meshlet.vertex_count + new_vertex_count > max_vertices || meshlet.index_count / 3 + 1 > max_triangles)
+        {
+            ComputeMeshletBounds(meshlet, result.bounds, indices, positions, vertex_stride);
+            result.meshlets.push_back(meshlet);
+
+            meshlet = {};
+            meshlet.first_index = (unsigned int)i;
+        }
+
+        const unsigned int current = (unsigned int)result.meshlets.size();
+        for (unsigned int corner = 0; corner < 3; ++corner)
+        {
+            unsigned int& used_by = vertex_meshlet[indices[i + corner]];
+            meshlet.vertex_count += used_by != current;
+            used_by = current;
+        }
+
+        meshlet.index_count += 3;
+    }
+
+    if (meshlet.index_count > 0)
+    {
+        ComputeMeshletBounds(meshlet, result.bounds, indices, positions, vertex_stride);
+        result.meshlets.push_back(meshlet);
+    }
+}
+
+void CullMeshlets(const MeshletMesh& mesh, const glm::mat4& model, const Camera& camera, JobSystem& jobs,
+    MeshletCullResult& result)
+{
+    const unsigned int meshlet_count = (unsigned int)mesh.meshlets.size();
+    const unsigned int batch_count = (meshlet_count + MESHLET_CULL_BATCH_SIZE - 1) / MESHLET_CULL_BATCH_SIZE;
+
+    result.visible_meshlets.resize(meshlet_count);
+    result.batch_visible_counts.resize(batch_count);
+
+    // Cull in the mesh's space, which keeps distances as they are for rigid transforms
+    const Frustum frustum = Frustum::FromMatrix(camera.GetProjViewMatrix() * model);
+    const glm::vec4 camera_position = glm::inverse(model) * glm::vec4(camera.GetPosition(), 1.f);
+    const glm::vec3 local_camera_position(camera_position.x, camera_position.y, camera_position.z);
+
+    JobGroup group;
+    jobs.ParallelFor(group, batch_count, 1, [&](unsigned int begin, unsigned int end)
+    {
+        for (unsigned int batch = begin; batch < end; ++batch)
+        {
+            unsigned int first = batch * MESHLET_CULL_BATCH_SIZE;
+            unsigned int last = std::min(first + MESHLET_CULL_BATCH_SIZE, meshlet_count);
+            unsigned int* visible = result.visible_meshlets.data() + first;
+
+            unsigned int frustum_visible_count = CullSpheres(frustum, mesh.bounds, first, last, visible);
+
+            unsigned int visible_count = 0;
+            for (unsigned int i = 0; i < frustum_visible_count; ++i)
+            {
+                const Meshlet& meshlet = mesh.meshlets[visible[i]];
+                glm::vec3 view = glm::normalize(meshlet.cone_apex - local_camera_position);
+                if (glm::dot(view, meshlet.cone_axis) < meshlet.cone_cutoff)
+                    visible[visible_count++] = visible[i];
+            }
+
+            result.batch_visible_counts[batch] = visible_count;
+        }
+    });
+    jobs.Wait(group);
+
+    result.ranges.clear();
+    result.visible_meshlet_count = 0;
+    result.visible_index_count = 0;
+    for (unsigned int batch = 0; batch < batch_count; ++batch)
+    {
+        const unsigned int* visible = result.visible_meshlets.data() + batch * MESHLET_CULL_BATCH_SIZE;
+        for (unsigned int i = 0; i < result.batch_visible_counts[batch]; ++i)
+        {
+            const Meshlet& meshlet = mesh.meshlets[visible[i]];
+            if (!result.ranges.empty() &&
+                result.ranges.back().first_index + result.ranges.back().index_count == meshlet.first_index)
+            {
+                result.ranges.back().index_count += meshlet.index_count;
+            }
+            else
+            {
+                result.ranges.push_back({ meshlet.first_index, meshlet.index_count });
+            }
+
+            ++result.visible_meshlet_count;
+            result.visible_index_count += meshlet.index_count;
+        }
+    }
+}
+}   // namespace Ogle
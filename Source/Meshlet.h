@@ -0,0 +1,70 @@
+#ifndef MESHLET_H
+
+#include "Camera.h"
+#include "Culling.h"
+#include "JobSystem.h"
+
+#include <glm/glm.hpp>
+#include <vector>
+
+namespace Ogle
+{
+// A cluster of neighbouring triangles, a contiguous range of the mesh's index buffer
+struct Meshlet
+{
+    unsigned int first_index;
+    unsigned int index_count;
+    unsigned int vertex_count;      // Unique vertices
+
+    // Every triangle faces away from a camera inside the cone: dot(normalize(apex - camera), axis) >= cutoff.
+    // cutoff > 1 means the triangles face too many directions for cone culling.
+    glm::vec3 cone_apex;
+    glm::vec3 cone_axis;
+    float cone_cutoff;
+};
+
+struct MeshletMesh
+{
+    static const unsigned int MAX_VERTICES = 64;
+    static const unsigned int MAX_TRIANGLES = 124;
+
+    std::vector<Meshlet> meshlets;
+    BoundingSpheres bounds;         // Per meshlet
+};
+
+// Greedily groups consecutive triangles into meshlets of at most max_vertices and max_triangles, so the index
+// buffer should be vertex cache optimized (OptimizeVertexCache) for compact meshlets. The meshlets index into the
+// same index buffer.
+void BuildMeshlets(MeshletMesh& result, const unsigned int* indices, size_t index_count, const float* positions,
+    size_t vertex_stride, unsigned int vertex_count, unsigned int max_vertices = MeshletMesh::MAX_VERTICES,
+    unsigned int max_triangles = MeshletMesh::MAX_TRIANGLES);
+
+// Index ranges to draw, e.g. with glMultiDrawElements
+struct DrawRange
+{
+    unsigned int first_index;
+    unsigned int index_count;
+};
+
+// Kept between frames to reuse the allocations
+struct MeshletCullResult
+{
+    std::vector<DrawRange> ranges;      // Adjacent visible meshlets get merged into one range
+    unsigned int visible_meshlet_count = 0;
+    unsigned int visible_index_count = 0;
+
+private:
+    friend void CullMeshlets(const MeshletMesh&, const glm::mat4&, const Camera&, JobSystem&, MeshletCullResult&);
+
+    std::vector<unsigned int> visible_meshlets;
+    std::vector<unsigned int> batch_visible_counts;
+};
+
+// Rejects the meshlets outside the camera's frustum or facing away from it, in parallel batches. model transforms
+// the mesh to world space and must not scale non-uniformly.
+void CullMeshlets(const MeshletMesh& mesh, const glm::mat4& model, const Camera& camera, JobSystem& jobs,
+    MeshletCullResult& result);
+}   // namespace Ogle
+
+#define MESHLET_H
+#endif
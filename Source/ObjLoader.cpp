@@ -0,0 +1,545 @@
+#include "ObjLoader.h"
+
+#include "MappedFile.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+
+namespace Ogle
+{
+static const int32_t OBJ_NO_INDEX = INT32_MIN;
+
+static const uint8_t RELATIVE_POSITION = 1 << 0;
+static const uint8_t RELATIVE_TEXCOORD = 1 << 1;
+static const uint8_t RELATIVE_NORMAL = 1 << 2;
+
+// Note: Files get split at line boundaries, the chunks shouldn't be too small for the per chunk overhead
+static const size_t OBJ_MIN_CHUNK_SIZE = 1 << 20;
+
+static const unsigned int OBJ_EMPTY_SLOT = ~0u;
+
+struct ObjCorner
+{
+    int32_t position;
+    int32_t texcoord;
+    int32_t normal;
+};
+
+static inline bool operator==(const ObjCorner& a, const ObjCorner& b)
+{
+    return a.position == b.position && a.texcoord == b.texcoord && a.normal == b.normal;
+}
+
+// Open addressing, the slots hold indices into a list of unique corners
+struct ObjCornerHashTable
+{
+    void Reset(size_t expected_count)
+    {
+        size_t size = 16;
+        while (size < 2 * expected_count)
+            size *= 2;
+
+        slots.assign(size, OBJ_EMPTY_SLOT);
+    }
+
+    // Returns the index of the equal corner in unique_corners, adds corner to them if there is none
+    unsigned int FindOrInsert(const ObjCorner& corner, std::vector<ObjCorner>& unique_corners)
+    {
+        const size_t mask = slots.size() - 1;
+
+        uint32_t hash = uint32_t(corner.position) * 0x9e3779b1u ^ uint32_t(corner.texcoord) * 0x85ebca77u ^
+            uint32_t(corner.normal) * 0xc2b2ae3du;
+        hash ^= hash >> 15;
+
+        for (size_t slot = hash & mask;; slot = (slot + 1) & mask)
+        {
+            if (slots[slot] == OBJ_EMPTY_SLOT)
+            {
+                slots[slot] = (unsigned int)unique_corners.size();
+                unique_corners.push_back(corner);
+                return slots[slot];
+            }
+
+            if (unique_corners[slots[slot]] == corner)
+                return slots[slot];
+        }
+    }
+
+private:
+    std::vector<unsigned int> slots;
+};
+
+struct ObjChunk
+{
+    const char* begin;
+    const char* end;
+
+    std::vector<float> positions;           // 3 per position
+    std::vector<float> texcoords;           // 2 per texcoord
+    std::vector<float> normals;             // 3 per normal
+    std::vector<ObjCorner> corners;         // 3 per triangle
+    std::vector<uint8_t> relative_flags;    // Per corner, which of its indices were negative
+
+    // Where this chunk's elements start in the whole file
+    unsigned int first_position = 0;
+    unsigned int first_texcoord = 0;
+    unsigned int first_normal = 0;
+    size_t first_corner = 0;
+
+    std::vector<ObjCorner> unique_corners;
+    std::vector<unsigned int> corner_vertices;  // Index into unique_corners per corner
+    std::vector<unsigned int> remap;            // From unique_corners to the final vertices
+
+    bool failed = false;
+};
+
+static inline bool IsSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+static inline bool IsDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+static inline const char* SkipSpaces(const char* c, const char* end)
+{
+    while (c < end && IsSpace(*c))
+        ++c;
+    return c;
+}
+
+// Locale independent and much faster than strtof, accurate up to the last bit in the vast majority of cases
+// which is more than enough for vertex data
+static const char* ParseFloat(const char* c, const char* end, float& result)
+{
+    static const double POWERS_OF_10[] =
+    {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18,
+        1e19, 1e20, 1e21, 1e22
+    };
+
+    c = SkipSpaces(c, end);
+
+    bool negative = false;
+    if (c < end && (*c == '-' || *c == '+'))
+        negative = *c++ == '-';
+
+    // 19 significant digits always fit in 64 bits
+    uint64_t mantissa = 0;
+    int significant_digits = 0;
+    int exponent = 0;
+
+    for (; c < end && IsDigit(*c); ++c)
+    {
+        if (significant_digits < 19)
+        {
+            mantissa = mantissa * 10 + uint64_t(*c - '0');
+            significant_digits += mantissa != 0;
+        }
+        else
+        {
+            ++exponent;
+        }
+    }
+
+    if (c < end && *c == '.')
+    {
+        for (++c; c < end && IsDigit(*c); ++c)
+        {
+            if (significant_digits < 19)
+            {
+                mantissa = mantissa * 10 + uint64_t(*c - '0');
+                significant_digits += mantissa != 0;
+                --exponent;
+            }
+        }
+    }
+
+    if (c < end && (*c == 'e' || *c == 'E'))
+    {
+        ++c;
+        bool negative_exponent = false;
+        if (c < end && (*c == '-' || *c == '+'))
+            negative_exponent = *c++ == '-';
+
+        int explicit_exponent = 0;
+        for (; c < end && IsDigit(*c); ++c)
+            explicit_exponent = std::min(explicit_exponent * 10 + (*c - '0'), 1000);
+
+        exponent += negative_exponent ? -explicit_exponent : explicit_exponent;
+    }
+
+    double value = double(mantissa);
+    if (mantissa != 0)
+    {
+        for (; exponent > 22; exponent -= 22)
+            value *= POWERS_OF_10[22];
+        for (; exponent < -22; exponent += 22)
+            value /= POWERS_OF_10[22];
+
+        value = exponent < 0 ? value / POWERS_OF_10[-exponent] : value * POWERS_OF_10[exponent];
+    }
+
+    result = float(negative ? -value : value);
+    return c;
+}
+
+static const char* ParseInt(const char* c, const char* end, int64_t& result)
+{
+    bool negative = false;
+    if (c < end && (*c == '-' || *c == '+'))
+        negative = *c++ == '-';
+
+    int64_t value = 0;
+    for (; c < end && IsDigit(*c); ++c)
+        value = std::min<int64_t>(value * 10 + (*c - '0'), INT32_MAX);
+
+    result = negative ? -value : value;
+    return c;
+}
+
+// OBJ indices are 1-based, negative ones count back from the last element seen so far. Those are stored relative to
+// the start of the chunk here and resolved once the preceding chunks' counts are known.
+static inline int32_t ToChunkIndex(int64_t index, size_t chunk_element_count, uint8_t relative_flag, uint8_t& flags,
+    bool& failed)
+{
+    if (index > 0)
+        return int32_t(index - 1);
+
+    if (index < 0)
+    {
+        flags |= relative_flag;
+        return int32_t(int64_t(chunk_element_count) + index);
+    }
+
+    failed = true;
+    return 0;
+}
+
+static void ParseChunk(ObjChunk& chunk)
+{
+    std::vector<ObjCorner> polygon;
+    std::vector<uint8_t> polygon_flags;
+
+    const char* c = chunk.begin;
+    while (c < chunk.end)
+    {
+        const char* line_end = (const char*)memchr(c, '\n', chunk.end - c);
+        if (!line_end)
+            line_end = chunk.end;
+
+        c = SkipSpaces(c, line_end);
+        if (line_end - c >= 2 && c[0] == 'v')
+        {
+            if (IsSpace(c[1]))
+            {
+                float x = 0.f, y = 0.f, z = 0.f;
+                c = ParseFloat(c + 2, line_end, x);
+                c = ParseFloat(c, line_end, y);
+                c = ParseFloat(c, line_end, z);
+                chunk.positions.insert(chunk.positions.end(), { x, y, z });
+            }
+            else if (c[1] == 't' && line_end - c >= 3 && IsSpace(c[2]))
+            {
+                float u = 0.f, v = 0.f;
+                c = ParseFloat(c + 3, line_end, u);
+                c = ParseFloat(c, line_end, v);
+                chunk.texcoords.insert(chunk.texcoords.end(), { u, v });
+            }
+            else if (c[1] == 'n' && line_end - c >= 3 && IsSpace(c[2]))
+            {
+                float x = 0.f, y = 0.f, z = 0.f;
+                c = ParseFloat(c + 3, line_end, x);
+                c = ParseFloat(c, line_end, y);
+                c = ParseFloat(c, line_end, z);
+                chunk.normals.insert(chunk.normals.end(), { x, y, z });
+            }
+        }
+        else if (line_end - c >= 2 && c[0] == 'f' && IsSpace(c[1]))
+        {
+            polygon.clear();
+            polygon_flags.clear();
+
+            for (c = SkipSpaces(c + 2, line_end); c < line_end && !IsSpace(*c); c = SkipSpaces(c, line_end))
+            {
+                ObjCorner corner = { 0, OBJ_NO_INDEX, OBJ_NO_INDEX };
+                uint8_t flags = 0;
+
+                int64_t index;
+                c = ParseInt(c, line_end, index);
+                corner.position = ToChunkIndex(index, chunk.positions.size() / 3, RELATIVE_POSITION, flags,
+                    chunk.failed);
+
+                if (c < line_end && *c == '/')
+                {
+                    ++c;
+                    if (c < line_end && *c != '/')
+                    {
+                        c = ParseInt(c, line_end, index);
+                        corner.texcoord = ToChunkIndex(index, chunk.texcoords.size() / 2, RELATIVE_TEXCOORD, flags,
+                            chunk.failed);
+                    }
+
+                    if (c < line_end && *c == '/')
+                    {
+                        c = ParseInt(c + 1, line_end, index);
+                        corner.normal = ToChunkIndex(index, chunk.normals.size() / 3, RELATIVE_NORMAL, flags,
+                            chunk.failed);
+                    }
+                }
+
+                // Anything else means a malformed corner, don't loop on it forever
+                if (c < line_end && !IsSpace(*c))
+                {
+                    chunk.failed = true;
+                    break;
+                }
+
+                polygon.push_back(corner);
+                polygon_flags.push_back(flags);
+            }
+
+            for (size_t i = 1; i + 1 < polygon.size(); ++i)
+            {
+                chunk.corners.insert(chunk.corners.end(), { polygon[0], polygon[i], polygon[i + 1] });
+                chunk.relative_flags.insert(chunk.relative_flags.end(),
+                    { polygon_flags[0], polygon_flags[i], polygon_flags[i + 1] });
+            }
+        }
+
+        c = line_end + 1;
+    }
+}
+
+static inline bool IsValidIndex(int32_t index, unsigned int count, bool optional)
+{
+    return (optional && index == OBJ_NO_INDEX) || (index >= 0 && (unsigned int)index < count);
+}
+
+// Makes the indices global and deduplicates the corners within the chunk
+static void ResolveChunk(ObjChunk& chunk, unsigned int position_count, unsigned int texcoord_count,
+    unsigned int normal_count)
+{
+    // Every corner can be unique, e.g. in triangle soups, so size for all of them to keep the load factor <= 0.5
+    ObjCornerHashTable table;
+    table.Reset(chunk.corners.size());
+
+    chunk.corner_vertices.resize(chunk.corners.size());
+
+    for (size_t i = 0; i < chunk.corners.size(); ++i)
+    {
+        ObjCorner& corner = chunk.corners[i];
+        uint8_t flags = chunk.relative_flags[i];
+
+        corner.position += (flags & RELATIVE_POSITION) ? chunk.first_position : 0;
+        corner.texcoord += (flags & RELATIVE_TEXCOORD) ? chunk.first_texcoord : 0;
+        corner.normal += (flags & RELATIVE_NORMAL) ? chunk.first_normal : 0;
+
+        if (!IsValidIndex(corner.position, position_count, false) || !IsValidIndex(corner.texcoord, texcoord_count, true)
+            || !IsValidIndex(corner.normal, normal_count, true))
+        {
+            chunk.failed = true;
+            return;
+        }
+
+        chunk.corner_vertices[i] = table.FindOrInsert(corner, chunk.unique_corners);
+    }
+
+    chunk.relative_flags = std::vector<uint8_t>();
+}
+
+MeshData* LoadObj(const char* path, JobSystem& jobs)
+{
+    MappedFile* file = MappedFile::Open(path);
+    if (!file)
+        return nullptr;
+
+    const char* data = file->GetData();
+    const size_t size = file->GetSize();
+
+    size_t chunk_count = std::min<size_t>(size_t(jobs.GetThreadCount()) * 4, size / OBJ_MIN_CHUNK_SIZE);
+    chunk_count = std::max<size_t>(chunk_count, 1);
+
+    std::vector<ObjChunk> chunks(chunk_count);
+    const char* chunk_begin = data;
+    for (size_t i = 0; i < chunk_count; ++i)
+    {
+        const char* chunk_end = data + size * (i + 1) / chunk_count;
+        if (i + 1 < chunk_count)
+        {
+            const char* newline = (const char*)memchr(chunk_end, '\n', data + size - chunk_end);
+            chunk_end = newline ? newline + 1 : data + size;
+        }
+
+        chunk_begin = std::min(chunk_begin, chunk_end);
+        chunks[i].begin = chunk_begin;
+        chunks[i].end = chunk_end;
+        chunk_begin = chunk_end;
+    }
+
+    {
+        JobGroup group;
+        jobs.ParallelFor(group, (unsigned int)chunk_count, 1, [&chunks](unsigned int begin, unsigned int end)
+        {
+            for (unsigned int i = begin; i < end; ++i)
+                ParseChunk(chunks[i]);
+        });
+        jobs.Wait(group);
+    }
+
+    unsigned int position_count = 0, texcoord_count = 0, normal_count = 0;
+    size_t corner_count = 0;
+    for (ObjChunk& chunk : chunks)
+    {
+        chunk.first_position = position_count;
+        chunk.first_texcoord = texcoord_count;
+        chunk.first_normal = normal_count;
+        chunk.first_corner = corner_count;
+
+        position_count += (unsigned int)(chunk.positions.size() / 3);
+        texcoord_count += (unsigned int)(chunk.texcoords.size() / 2);
+        normal_count += (unsigned int)(chunk.normals.size() / 3);
+        corner_count += chunk.corners.size();
+    }
+
+    {
+        JobGroup group;
+        jobs.ParallelFor(group, (unsigned int)chunk_count, 1, [&](unsigned int begin, unsigned int end)
+        {
+            for (unsigned int i = begin; i < end; ++i)
+            {
+                if (!chunks[i].failed)
+                    ResolveChunk(chunks[i], position_count, texcoord_count, normal_count);
+            }
+        });
+        jobs.Wait(group);
+    }
+
+    for (const ObjChunk& chunk : chunks)
+    {
+        if (chunk.failed)
+        {
+            std::cout << "Invalid OBJ file: " << path << std::endl;
+            delete file;
+            return nullptr;
+        }
+    }
+
+    // Note: Only the corners which are unique within their chunk get merged here, that is serial but a fraction of
+    // the work since vertices are usually shared by several triangles
+    std::vector<ObjCorner> vertex_corners;
+    {
+        size_t unique_corner_count = 0;
+        for (const ObjChunk& chunk : chunks)
+            unique_corner_count += chunk.unique_corners.size();
+
+        ObjCornerHashTable table;
+        table.Reset(unique_corner_count);
+        vertex_corners.reserve(unique_corner_count);
+
+        for (ObjChunk& chunk : chunks)
+        {
+            chunk.remap.resize(chunk.unique_corners.size());
+            for (size_t i = 0; i < chunk.unique_corners.size(); ++i)
+                chunk.remap[i] = table.FindOrInsert(chunk.unique_corners[i], vertex_corners);
+        }
+    }
+
+    MeshData* result = new MeshData;
+
+    const bool has_normals = normal_count > 0;
+    const bool has_texcoords = texcoord_count > 0;
+
+    result->attribs[result->attrib_count++] = { 3, 0 };
+    result->vertex_stride = 3 * sizeof(float);
+    if (has_normals)
+    {
+        result->attribs[result->attrib_count++] = { 3, result->vertex_stride };
+        result->vertex_stride += 3 * sizeof(float);
+    }
+    if (has_texcoords)
+    {
+        result->attribs[result->attrib_count++] = { 2, result->vertex_stride };
+        result->vertex_stride += 2 * sizeof(float);
+    }
+
+    result->vertices.resize(vertex_corners.size() * result->vertex_stride);
+    result->indices.resize(corner_count);
+
+    {
+        JobGroup group;
+
+        jobs.ParallelFor(group, (unsigned int)chunk_count, 1, [&](unsigned int begin, unsigned int end)
+        {
+            for (unsigned int i = begin; i < end; ++i)
+            {
+                const ObjChunk& chunk = chunks[i];
+                unsigned int* indices = result->indices.data() + chunk.first_corner;
+                for (size_t j = 0; j < chunk.corner_vertices.size(); ++j)
+                    indices[j] = chunk.remap[chunk.corner_vertices[j]];
+            }
+        });
+
+        // The elements live in the chunk which declared them
+        auto find_chunk = [&chunks](unsigned int index, unsigned int ObjChunk::* first) -> const ObjChunk&
+        {
+            auto it = std::upper_bound(chunks.begin(), chunks.end(), index,
+                [first](unsigned int value, const ObjChunk& chunk) { return value < chunk.*first; });
+            return *(it - 1);
+        };
+
+        jobs.ParallelFor(group, (unsigned int)vertex_corners.size(), 16 * 1024, [&](unsigned int begin, unsigned int end)
+        {
+            for (unsigned int i = begin; i < end; ++i)
+            {
+                const ObjCorner& corner = vertex_corners[i];
+                float* vertex = (float*)(result->vertices.data() + size_t(i) * result->vertex_stride);
+
+                const ObjChunk& position_chunk = find_chunk(corner.position, &ObjChunk::first_position);
+                memcpy(vertex, &position_chunk.positions[3 * size_t(corner.position - position_chunk.first_position)],
+                    3 * sizeof(float));
+                vertex += 3;
+
+                if (has_normals)
+                {
+                    if (corner.normal != OBJ_NO_INDEX)
+                    {
+                        const ObjChunk& normal_chunk = find_chunk(corner.normal, &ObjChunk::first_normal);
+                        memcpy(vertex, &normal_chunk.normals[3 * size_t(corner.normal - normal_chunk.first_normal)],
+                            3 * sizeof(float));
+                    }
+                    else
+                    {
+                        vertex[0] = vertex[1] = vertex[2] = 0.f;
+                    }
+                    vertex += 3;
+                }
+
+                if (has_texcoords)
+                {
+                    if (corner.texcoord != OBJ_NO_INDEX)
+                    {
+                        const ObjChunk& texcoord_chunk = find_chunk(corner.texcoord, &ObjChunk::first_texcoord);
+                        memcpy(vertex,
+                            &texcoord_chunk.texcoords[2 * size_t(corner.texcoord - texcoord_chunk.first_texcoord)],
+                            2 * sizeof(float));
+                    }
+                    else
+                    {
+                        vertex[0] = vertex[1] = 0.f;
+                    }
+                }
+            }
+        });
+
+        jobs.Wait(group);
+    }
+
+    delete file;
+    return result;
+}
+}   // namespace Ogle
@@ -0,0 +1,16 @@
+#ifndef OBJ_LOADER_H
+
+#include "JobSystem.h"
+#include "MeshData.h"
+
+namespace Ogle
+{
+// Loads the faces of a Wavefront OBJ file, polygons get triangulated as fans and everything besides positions,
+// texture coordinates and normals (groups, materials, lines) is skipped. The vertex layout is position, then normal
+// and texture coordinate if the file has any. The file is parsed in parallel chunks on jobs, returns nullptr on
+// failure.
+MeshData* LoadObj(const char* path, JobSystem& jobs);
+}   // namespace Ogle
+
+#define OBJ_LOADER_H
+#endif
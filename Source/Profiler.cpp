@@ -0,0 +1,206 @@
+#include "Profiler.h"
+
+#include <imgui.h>
+#include <cfloat>
+#include <cstdio>
+
+namespace Ogle
+{
+Profiler::~Profiler()
+{
+    if (!initialized)
+        return;
+
+    for (unsigned int i = 0; i < FRAME_LATENCY; ++i)
+        glDeleteQueries(2 * MAX_GPU_ZONES_PER_FRAME, frames[i].queries);
+}
+
+void Profiler::Initialize()
+{
+    for (unsigned int i = 0; i < FRAME_LATENCY; ++i)
+        glGenQueries(2 * MAX_GPU_ZONES_PER_FRAME, frames[i].queries);
+
+    initialized = true;
+}
+
+void Profiler::BeginFrame()
+{
+    if (!initialized)
+        return;
+
+    // This slot was last used FRAME_LATENCY frames ago
+    FrameQueries& frame = frames[frame_index % FRAME_LATENCY];
+    if (frame.pending)
+        ResolveGPUFrame(frame);
+
+    frame.count = 0;
+    frame.last_query = -1;
+    frame.pending = false;
+}
+
+void Profiler::EndFrame()
+{
+    for (Zone& zone : zones)
+    {
+        zone.cpu_history[cpu_history_offset] = 1000.f * zone.cpu_frame_time;
+        zone.cpu_frame_time = 0.f;
+    }
+    cpu_history_offset = (cpu_history_offset + 1) % HISTORY_LENGTH;
+
+    if (initialized)
+    {
+        FrameQueries& frame = frames[frame_index % FRAME_LATENCY];
+        frame.pending = frame.count > 0;
+        ++frame_index;
+    }
+}
+
+unsigned int Profiler::GetZone(const char* name)
+{
+    auto it = zone_lookup.find(name);
+    if (it != zone_lookup.end())
+        return it->second;
+
+    unsigned int zone = (unsigned int)zones.size();
+    zones.emplace_back();
+    zones.back().name = name;
+
+    zone_lookup[name] = zone;
+    return zone;
+}
+
+void Profiler::AddCPUTime(unsigned int zone, float seconds)
+{
+    zones[zone].cpu_frame_time += seconds;
+}
+
+int Profiler::BeginGPUZone(unsigned int zone)
+{
+    if (!initialized)
+        return -1;
+
+    FrameQueries& frame = frames[frame_index % FRAME_LATENCY];
+    if (frame.count == MAX_GPU_ZONES_PER_FRAME)
+        return -1;
+
+    int query_pair = (int)frame.count++;
+    frame.zones[query_pair] = zone;
+    glQueryCounter(frame.queries[2 * query_pair], GL_TIMESTAMP);
+    frame.last_query = 2 * query_pair;
+
+    zones[zone].has_gpu_time = true;
+    return query_pair;
+}
+
+void Profiler::EndGPUZone(int query_pair)
+{
+    if (query_pair < 0)
+        return;
+
+    FrameQueries& frame = frames[frame_index % FRAME_LATENCY];
+    glQueryCounter(frame.queries[2 * query_pair + 1], GL_TIMESTAMP);
+    frame.last_query = 2 * query_pair + 1;
+}
+
+void Profiler::ResolveGPUFrame(FrameQueries& frame)
+{
+    // Queries complete in order, so the last one issued being available means all of them are. Note: Not the last
+    // pair's end, the outer zones end after their nested ones.
+    GLint available = GL_FALSE;
+    glGetQueryObjectiv(frame.queries[frame.last_query], GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available)
+    {
+        ++dropped_gpu_frame_count;
+        return;
+    }
+
+    for (unsigned int i = 0; i < frame.count; ++i)
+    {
+        GLuint64 begin, end;
+        glGetQueryObjectui64v(frame.queries[2 * i], GL_QUERY_RESULT, &begin);
+        glGetQueryObjectui64v(frame.queries[2 * i + 1], GL_QUERY_RESULT, &end);
+
+        zones[frame.zones[i]].gpu_frame_time += float(double(end - begin) * 1e-9);
+    }
+
+    for (Zone& zone : zones)
+    {
+        zone.gpu_history[gpu_history_offset] = 1000.f * zone.gpu_frame_time;
+        zone.gpu_frame_time = 0.f;
+    }
+    gpu_history_offset = (gpu_history_offset + 1) % HISTORY_LENGTH;
+}
+
+void Profiler::DrawOverlay(bool* open) const
+{
+    ImGui::SetNextWindowSize(ImVec2(420.f, 0.f), ImGuiCond_FirstUseEver);
+    if (!ImGui::Begin("Profiler", open))
+    {
+        ImGui::End();
+        return;
+    }
+
+    if (dropped_gpu_frame_count > 0)
+        ImGui::Text("GPU frames dropped (results not ready): %u", dropped_gpu_frame_count);
+
+    auto average = [](const float* history)
+    {
+        float sum = 0.f;
+        for (unsigned int i = 0; i < HISTORY_LENGTH; ++i)
+            sum += history[i];
+        return sum / HISTORY_LENGTH;
+    };
+
+    auto maximum = [](const float* history)
+    {
+        float result = 0.f;
+        for (unsigned int i = 0; i < HISTORY_LENGTH; ++i)
+            result = history[i] > result ? history[i] : result;
+        return result;
+    };
+
+    for (const Zone& zone : zones)
+    {
+        ImGui::PushID(zone.name);
+        if (ImGui::CollapsingHeader(zone.name, ImGuiTreeNodeFlags_DefaultOpen))
+        {
+            char overlay[64];
+
+            snprintf(overlay, sizeof(overlay), "CPU avg %.3f ms, max %.3f ms", average(zone.cpu_history),
+                maximum(zone.cpu_history));
+            ImGui::PlotLines("##cpu", zone.cpu_history, HISTORY_LENGTH, cpu_history_offset, overlay, 0.f, FLT_MAX,
+                ImVec2(-1.f, 40.f));
+
+            if (zone.has_gpu_time)
+            {
+                snprintf(overlay, sizeof(overlay), "GPU avg %.3f ms, max %.3f ms", average(zone.gpu_history),
+                    maximum(zone.gpu_history));
+                ImGui::PlotLines("##gpu", zone.gpu_history, HISTORY_LENGTH, gpu_history_offset, overlay, 0.f,
+                    FLT_MAX, ImVec2(-1.f, 40.f));
+            }
+        }
+        ImGui::PopID();
+    }
+
+    ImGui::End();
+}
+
+CPUProfileScope::CPUProfileScope(Profiler& profiler_, const char* name) : profiler(profiler_),
+    zone(profiler_.GetZone(name)), start(std::chrono::steady_clock::now())
+{}
+
+CPUProfileScope::~CPUProfileScope()
+{
+    std::chrono::duration<float> duration = std::chrono::steady_clock::now() - start;
+    profiler.AddCPUTime(zone, duration.count());
+}
+
+GPUProfileScope::GPUProfileScope(Profiler& profiler_, const char* name) : profiler(profiler_),
+    query_pair(profiler_.BeginGPUZone(profiler_.GetZone(name)))
+{}
+
+GPUProfileScope::~GPUProfileScope()
+{
+    profiler.EndGPUZone(query_pair);
+}
+}   // namespace Ogle
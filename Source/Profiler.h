@@ -0,0 +1,109 @@
+#ifndef PROFILER_H
+
+#include <glad/glad.h>
+#include <chrono>
+#include <unordered_map>
+#include <vector>
+
+#define OGLE_PROFILER_CONCAT_IMPL(a, b) a##b
+#define OGLE_PROFILER_CONCAT(a, b) OGLE_PROFILER_CONCAT_IMPL(a, b)
+
+// Name must be a string literal (or otherwise outlive the profiler), zones are identified by its address
+#define OGLE_PROFILE_CPU_SCOPE(profiler, name) \
+    Ogle::CPUProfileScope OGLE_PROFILER_CONCAT(ogle_cpu_profile_scope_, __LINE__)(profiler, name)
+#define OGLE_PROFILE_GPU_SCOPE(profiler, name) \
+    Ogle::GPUProfileScope OGLE_PROFILER_CONCAT(ogle_gpu_profile_scope_, __LINE__)(profiler, name)
+#define OGLE_PROFILE_SCOPE(profiler, name) \
+    OGLE_PROFILE_CPU_SCOPE(profiler, name); OGLE_PROFILE_GPU_SCOPE(profiler, name)
+
+namespace Ogle
+{
+// GPU zones are bracketed by GL_TIMESTAMP queries (unlike GL_TIME_ELAPSED they can nest). Queries of a frame are
+// only read back FRAME_LATENCY frames later and only if they are already available, so the profiler never stalls
+// the pipeline; a frame whose results are still pending is dropped from the GPU history instead.
+struct Profiler
+{
+    static constexpr unsigned int FRAME_LATENCY = 4;
+    static constexpr unsigned int HISTORY_LENGTH = 128;
+    static constexpr unsigned int MAX_GPU_ZONES_PER_FRAME = 64;
+
+    ~Profiler();
+
+    // Requires a current GL context
+    void Initialize();
+
+    void BeginFrame();
+    void EndFrame();
+
+    unsigned int GetZone(const char* name);
+
+    void AddCPUTime(unsigned int zone, float seconds);
+
+    // Returns the index of the timestamp pair to pass to EndGPUZone, or -1 if the zone couldn't be recorded
+    int BeginGPUZone(unsigned int zone);
+    void EndGPUZone(int query_pair);
+
+    void DrawOverlay(bool* open = nullptr) const;
+
+    inline bool IsInitialized() const { return initialized; }
+    inline unsigned int GetDroppedGPUFrameCount() const { return dropped_gpu_frame_count; }
+
+private:
+    struct Zone
+    {
+        const char* name;
+        float cpu_history[HISTORY_LENGTH] = {};
+        float gpu_history[HISTORY_LENGTH] = {};
+        float cpu_frame_time = 0.f;
+        float gpu_frame_time = 0.f;
+        bool has_gpu_time = false;
+    };
+
+    struct FrameQueries
+    {
+        GLuint queries[2 * MAX_GPU_ZONES_PER_FRAME];
+        unsigned int zones[MAX_GPU_ZONES_PER_FRAME];
+        unsigned int count = 0;
+        int last_query = -1;        // Issued last, e.g. the end of the outer zone, not of the last zone to begin
+        bool pending = false;
+    };
+
+    void ResolveGPUFrame(FrameQueries& frame);
+
+    std::vector<Zone> zones;
+    std::unordered_map<const char*, unsigned int> zone_lookup;
+
+    FrameQueries frames[FRAME_LATENCY];
+    unsigned int frame_index = 0;
+
+    unsigned int cpu_history_offset = 0;
+    unsigned int gpu_history_offset = 0;
+    unsigned int dropped_gpu_frame_count = 0;
+
+    bool initialized = false;
+};
+
+struct CPUProfileScope
+{
+    CPUProfileScope(Profiler& profiler_, const char* name);
+    ~CPUProfileScope();
+
+private:
+    Profiler& profiler;
+    unsigned int zone;
+    std::chrono::steady_clock::time_point start;
+};
+
+struct GPUProfileScope
+{
+    GPUProfileScope(Profiler& profiler_, const char* name);
+    ~GPUProfileScope();
+
+private:
+    Profiler& profiler;
+    int query_pair;
+};
+}   // namespace Ogle
+
+#define PROFILER_H
+#endif
@@ -0,0 +1,60 @@
+#include "RenderCommandBuffer.h"
+
+namespace Ogle
+{
+RenderCommandBuffer::~RenderCommandBuffer()
+{
+    Clear();
+
+    for (Block& block : blocks)
+        ::operator delete(block.memory);
+}
+
+void RenderCommandBuffer::Execute()
+{
+    Consume(true);
+}
+
+void RenderCommandBuffer::Clear()
+{
+    Consume(false);
+}
+
+void* RenderCommandBuffer::Allocate(size_t size)
+{
+    size = AlignSize(size);
+
+    if (!blocks.empty() && blocks[current_block].used + size > BLOCK_SIZE)
+        ++current_block;
+
+    if (current_block == blocks.size())
+        blocks.push_back({ (uint8_t*)::operator new(BLOCK_SIZE), 0 });
+
+    Block& block = blocks[current_block];
+    void* result = block.memory + block.used;
+    block.used += size;
+
+    return result;
+}
+
+void RenderCommandBuffer::Consume(bool execute)
+{
+    for (size_t i = 0; i <= current_block && i < blocks.size(); ++i)
+    {
+        Block& block = blocks[i];
+
+        size_t offset = 0;
+        while (offset < block.used)
+        {
+            Header* header = (Header*)(block.memory + offset);
+            header->invoke(header + 1, execute);
+            offset += header->size;
+        }
+
+        block.used = 0;
+    }
+
+    current_block = 0;
+    command_count = 0;
+}
+}   // namespace Ogle
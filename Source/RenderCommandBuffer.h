@@ -0,0 +1,87 @@
+#ifndef RENDER_COMMAND_BUFFER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Ogle
+{
+// A stream of type erased callables, stored inline in fixed size blocks so that recording a command doesn't
+// allocate once the buffer is warmed up. Commands run in the order they were pushed.
+struct RenderCommandBuffer
+{
+    static constexpr size_t BLOCK_SIZE = 64 * 1024;
+
+    RenderCommandBuffer() = default;
+    RenderCommandBuffer(const RenderCommandBuffer&) = delete;
+    RenderCommandBuffer& operator=(const RenderCommandBuffer&) = delete;
+    ~RenderCommandBuffer();
+
+    template <typename F>
+    void Push(F&& function)
+    {
+        using Command = typename std::decay<F>::type;
+        static_assert(sizeof(Header) + sizeof(Command) <= BLOCK_SIZE, "Render command is too big");
+        static_assert(alignof(Command) <= alignof(std::max_align_t), "Render command is over-aligned");
+
+        void* memory = Allocate(sizeof(Header) + sizeof(Command));
+
+        Header* header = new (memory) Header;
+        header->invoke = &Invoke<Command>;
+        header->size = (uint32_t)AlignSize(sizeof(Header) + sizeof(Command));
+
+        new (header + 1) Command(std::forward<F>(function));
+        ++command_count;
+    }
+
+    // Runs and destroys every command, the memory is kept for the next frame
+    void Execute();
+
+    // Destroys every command without running it
+    void Clear();
+
+    inline bool IsEmpty() const { return command_count == 0; }
+    inline unsigned int GetCommandCount() const { return command_count; }
+
+private:
+    struct alignas(std::max_align_t) Header
+    {
+        void (*invoke)(void* command, bool execute);
+        uint32_t size;
+    };
+
+    template <typename Command>
+    static void Invoke(void* command, bool execute)
+    {
+        Command* typed_command = (Command*)command;
+        if (execute)
+            (*typed_command)();
+        typed_command->~Command();
+    }
+
+    static inline size_t AlignSize(size_t size)
+    {
+        const size_t alignment = alignof(std::max_align_t);
+        return (size + alignment - 1) & ~(alignment - 1);
+    }
+
+    void* Allocate(size_t size);
+    void Consume(bool execute);
+
+    struct Block
+    {
+        uint8_t* memory;
+        size_t used;
+    };
+
+    std::vector<Block> blocks;
+    size_t current_block = 0;
+    unsigned int command_count = 0;
+};
+}   // namespace Ogle
+
+#define RENDER_COMMAND_BUFFER_H
+#endif
@@ -95,6 +95,12 @@ void Shader::SetMat4(const char* name, const GLfloat* value, GLboolean transpose
     glUniformMatrix4fv(location, 1, transpose, value);
 }
 
+void Shader::SetMat4Array(const char* name, const GLfloat* values, GLsizei count, GLboolean transpose)
+{
+    GLint location = GetUniformLocation(name);
+    glUniformMatrix4fv(location, count, transpose, values);
+}
+
 void Shader::SetVec2(const char* name, const GLfloat x, const GLfloat y)
 {
     GLint location = GetUniformLocation(name);
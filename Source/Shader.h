@@ -32,6 +32,8 @@ struct Shader
     void SetUnsignedInt(const char* name, const GLuint value);
     void SetFloat(const char* name, const GLfloat value);
     void SetMat4(const char* name, const GLfloat* value, GLboolean transpose = false);
+    // count matrices, uniform arrays are small (about 1k mat4s), use an InstanceBuffer for more
+    void SetMat4Array(const char* name, const GLfloat* values, GLsizei count, GLboolean transpose = false);
     void SetVec2(const char* name, const GLfloat x, const GLfloat y);
     void SetVec3(const char* name, const GLfloat x, const GLfloat y, const GLfloat z);
 
@@ -0,0 +1,84 @@
+#include "StreamBuffer.h"
+
+#include <iostream>
+
+namespace Ogle
+{
+StreamBuffer::StreamBuffer(size_t frame_size_) : frame_size(frame_size_)
+{
+    const GLsizeiptr size = GLsizeiptr(frame_size) * FRAME_COUNT;
+    const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+    glCreateBuffers(1, &id);
+    glNamedBufferStorage(id, size, nullptr, flags);
+    mapped = (unsigned char*)glMapNamedBufferRange(id, 0, size, flags);
+    if (!mapped)
+    {
+        std::cout << "Failed to map stream buffer of " << size << " bytes" << std::endl;
+        frame_size = 0;
+    }
+}
+
+StreamBuffer::~StreamBuffer()
+{
+    for (GLsync& fence : fences)
+    {
+        if (fence)
+            glDeleteSync(fence);
+    }
+
+    if (mapped)
+        glUnmapNamedBuffer(id);
+    glDeleteBuffers(1, &id);
+}
+
+void StreamBuffer::BeginFrame()
+{
+    head = 0;
+
+    GLsync& fence = fences[frame];
+    if (!fence)
+        return;
+
+    GLenum result = glClientWaitSync(fence, 0, 0);
+    if (result == GL_TIMEOUT_EXPIRED)
+    {
+        ++stall_count;
+        result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+    }
+
+    if (result == GL_WAIT_FAILED)
+        std::cout << "Waiting on a stream buffer fence failed" << std::endl;
+
+    glDeleteSync(fence);
+    fence = nullptr;
+}
+
+void StreamBuffer::EndFrame()
+{
+    fences[frame] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    frame = (frame + 1) % FRAME_COUNT;
+}
+
+StreamAllocation StreamBuffer::Allocate(size_t size, size_t alignment)
+{
+    StreamAllocation result;
+
+    // Offsets are aligned relative to the buffer, the regions start at multiples of frame_size
+    const size_t region_offset = size_t(frame) * frame_size;
+    // Not a mask, vertex sizes like 12 or 20 bytes aren't powers of two
+    const size_t offset = (region_offset + head + alignment - 1) / alignment * alignment - region_offset;
+    if (offset + size > frame_size)
+    {
+        ++failed_allocation_count;
+        return result;
+    }
+
+    head = offset + size;
+
+    result.cpu_pointer = mapped + region_offset + offset;
+    result.gpu_offset = GLintptr(region_offset + offset);
+    result.size = size;
+    return result;
+}
+}   // namespace Ogle
@@ -0,0 +1,68 @@
+#ifndef STREAM_BUFFER_H
+
+#include <glad/glad.h>
+#include <cstddef>
+
+namespace Ogle
+{
+// Where an allocation lives: write through cpu_pointer, point GL at gpu_offset in the StreamBuffer's buffer.
+// cpu_pointer is null if the frame's region ran out of space.
+struct StreamAllocation
+{
+    void* cpu_pointer = nullptr;
+    GLintptr gpu_offset = 0;
+    size_t size = 0;
+};
+
+// For data rebuilt every frame (debug lines, UI, particles, per draw constants). One buffer is created with
+// glBufferStorage and stays persistently and coherently mapped, split into FRAME_COUNT regions. Each frame
+// linearly allocates from its own region, and EndFrame() fences it, so the CPU only ever writes a region the GPU
+// has finished reading: BeginFrame() waits on the fence from FRAME_COUNT frames ago, which has usually signaled
+// long before. Nothing gets reallocated or orphaned. Must be used on the thread owning the GL context.
+struct StreamBuffer
+{
+    static constexpr unsigned int FRAME_COUNT = 3;
+
+    explicit StreamBuffer(size_t frame_size_);
+    ~StreamBuffer();
+
+    StreamBuffer(const StreamBuffer&) = delete;
+    StreamBuffer& operator=(const StreamBuffer&) = delete;
+
+    void BeginFrame();
+    void EndFrame();
+
+    // Any alignment, e.g. GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT for glBindBufferRange, or the vertex size so that
+    // gpu_offset / vertex size is the draw's base vertex
+    StreamAllocation Allocate(size_t size, size_t alignment = 16);
+
+    inline void Bind(GLenum target) const { glBindBuffer(target, id); }
+    inline void BindRange(GLenum target, GLuint index, const StreamAllocation& allocation) const
+    {
+        glBindBufferRange(target, index, id, allocation.gpu_offset, allocation.size);
+    }
+
+    inline GLuint GetId() const { return id; }
+    inline size_t GetFrameSize() const { return frame_size; }
+    inline size_t GetFrameUsedSize() const { return head; }
+
+    // Frames where BeginFrame() had to block on the GPU, and allocations that didn't fit
+    inline unsigned int GetStallCount() const { return stall_count; }
+    inline unsigned int GetFailedAllocationCount() const { return failed_allocation_count; }
+
+private:
+    GLuint id = 0;
+    unsigned char* mapped = nullptr;
+    size_t frame_size;
+
+    GLsync fences[FRAME_COUNT] = {};
+    unsigned int frame = 0;
+    size_t head = 0;
+
+    unsigned int stall_count = 0;
+    unsigned int failed_allocation_count = 0;
+};
+}   // namespace Ogle
+
+#define STREAM_BUFFER_H
+#endif
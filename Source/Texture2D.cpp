@@ -23,6 +23,41 @@ Texture2D::Texture2D(unsigned int width_, unsigned int height_, GLint internal_f
     Unbind();
 }
 
+static Texture2D* CreateFromPixels(stbi_uc* data, int width, int height, int channel_count)
+{
+    GLint internal_format(-1);
+    GLenum format(-1);
+
+    switch (channel_count)
+    {
+        case 1:
+        {
+            internal_format = GL_R8;
+            format = GL_RED;
+        } break;
+
+        case 3:
+        {
+            internal_format = GL_RGB8;
+            format = GL_RGB;
+        } break;
+
+        case 4:
+        {
+            internal_format = GL_RGBA8;
+            format = GL_RGBA;
+        } break;
+
+        default:
+        {
+            std::cout << "File format not supported yet!" << std::endl;
+        } break;
+    }
+
+    return new Texture2D(width, height, internal_format, format, GL_UNSIGNED_BYTE, GL_NEAREST, GL_NEAREST,
+        GL_CLAMP_TO_BORDER, GL_CLAMP_TO_BORDER, data);
+}
+
 Texture2D* Texture2D::CreateFromFile(const char* path, bool flip_vertically)
 {
     Texture2D* result = nullptr;
@@ -33,43 +68,29 @@ Texture2D* Texture2D::CreateFromFile(const char* path, bool flip_vertically)
     stbi_uc* data = stbi_load(path, &width, &height, &channel_count, 0);
 
     if (data)
-    {
-        GLint internal_format(-1);
-        GLenum format(-1);
-
-        switch (channel_count)
-        {
-            case 1:
-            {
-                internal_format = GL_R8;
-                format = GL_RED;
-            } break;
-
-            case 3:
-            {
-                internal_format = GL_RGB8;
-                format = GL_RGB;
-            } break;
-
-            case 4:
-            {
-                internal_format = GL_RGBA8;
-                format = GL_RGBA;
-            } break;
-
-            default:
-            {
-                std::cout << "File format not supported yet!" << std::endl;
-            } break;
-        }
-
-        result = new Texture2D(width, height, internal_format, format, GL_UNSIGNED_BYTE, GL_NEAREST, GL_NEAREST,
-            GL_CLAMP_TO_BORDER, GL_CLAMP_TO_BORDER, data);
-    }
+        result = CreateFromPixels(data, width, height, channel_count);
     else
-    {
         std::cout << "Failed to load image at path: " << path << std::endl;
-    }
+
+    stbi_image_free(data);
+
+    return result;
+}
+
+Texture2D* Texture2D::CreateFromMemory(const void* file_data, size_t file_size, bool flip_vertically)
+{
+    Texture2D* result = nullptr;
+
+    stbi_set_flip_vertically_on_load(flip_vertically);
+
+    int width, height, channel_count;
+    stbi_uc* data = stbi_load_from_memory((const stbi_uc*)file_data, (int)file_size, &width, &height, &channel_count,
+        0);
+
+    if (data)
+        result = CreateFromPixels(data, width, height, channel_count);
+    else
+        std::cout << "Failed to load image from memory: " << stbi_failure_reason() << std::endl;
 
     stbi_image_free(data);
 
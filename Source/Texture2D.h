@@ -1,6 +1,7 @@
 #ifndef TEXTURE_2D_H
 
 #include <glad/glad.h>
+#include <cstddef>
 
 namespace Ogle
 {
@@ -12,6 +13,9 @@ struct Texture2D
 
     static Texture2D* CreateFromFile(const char* path, bool flip_vertically = false);
 
+    // Decodes an image file (PNG, JPEG, ...) which is already in memory
+    static Texture2D* CreateFromMemory(const void* file_data, size_t file_size, bool flip_vertically = false);
+
     inline void Bind(const unsigned int unit = 0) const
     {
         glActiveTexture(GL_TEXTURE0 + unit);